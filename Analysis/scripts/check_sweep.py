@@ -0,0 +1,47 @@
+"""
+Check that a cube of a CoCsCube sweep run scores what it scores alone.
+
+Reads the Deposits tables of macros/sweep_check.mac (run 0: the cube alone,
+copy 0; run 1: the same cube among the sweep cubes, copy 500250) and prints
+the mean deposit per primary of each, with its standard error, and their
+difference in standard errors.
+
+Usage: python check_sweep.py <output dir> <primaries per run> [sweep copy]
+"""
+import os
+import sys
+
+import numpy as np
+
+from Analysis.models.CubeCopy import encode_sweep_copy
+from Analysis.utils import G4Tools
+
+
+def read_deposits(out_dir : str, run : int):
+    phx = f"{out_dir}/run_{run}_Deposits.phx"
+    if os.path.exists(phx):
+        return G4Tools.read_phx(phx, ["fEvent", "Copy", "fEdep"])
+    return G4Tools.gen_run_dataframe(f"{out_dir}/run_{run}_Deposits.csv")
+
+
+def mean_deposit(df, copy : int, n_primaries : int):
+    # Events without a deposit in the cube count as zero
+    per_event = df[df["Copy"] == copy].groupby("fEvent")["fEdep"].sum().to_numpy()
+    edep = np.zeros(n_primaries)
+    edep[:len(per_event)] = per_event
+    return edep.mean(), edep.std(ddof=1) / np.sqrt(n_primaries)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+    out_dir, n_primaries = sys.argv[1], int(sys.argv[2])
+    sweep_copy = int(sys.argv[3]) if len(sys.argv) > 3 else encode_sweep_copy(25., 5.)
+
+    alone, err_alone = mean_deposit(read_deposits(out_dir, 0), 0, n_primaries)
+    swept, err_swept = mean_deposit(read_deposits(out_dir, 1), sweep_copy, n_primaries)
+    pull = (swept - alone) / np.hypot(err_alone, err_swept)
+
+    print(f"alone : {alone:.6e} +- {err_alone:.1e} MeV/primary")
+    print(f"sweep : {swept:.6e} +- {err_swept:.1e} MeV/primary (copy {sweep_copy})")
+    print(f"difference: {pull:+.2f} sigma -> {'compatible' if abs(pull) < 3 else 'NOT compatible'}")
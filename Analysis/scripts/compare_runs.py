@@ -0,0 +1,44 @@
+"""
+Compare two runs of the same macro under different settings (region cuts,
+physics profile) from their <run>_summary.csv files.
+
+Prints both summaries side by side, checks that the mean deposit of every
+crystal copy agrees within the errors, and gives the time saved by the
+second run at equal crystal-dose accuracy: 1 - FOM_ref / FOM_new, with the
+worst copy's figure of merit FOM = 1 / (relErr^2 * T).
+
+Usage: python compare_runs.py <reference summary.csv> <new summary.csv>
+"""
+import csv
+import math
+import sys
+
+
+def read_summary(path : str):
+    with open(path, newline="") as f:
+        return {row["key"]: row["value"] for row in csv.DictReader(f)}
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+    ref, new = read_summary(sys.argv[1]), read_summary(sys.argv[2])
+
+    keys = list(ref) + [k for k in new if k not in ref]
+    print(f"{'':24s} {'reference':>14s} {'new':>14s}")
+    for key in keys:
+        print(f"{key:24s} {ref.get(key, '-'):>14s} {new.get(key, '-'):>14s}")
+
+    copies = [k[len("edep_mean_MeV_"):] for k in ref if k.startswith("edep_mean_MeV_")]
+    for copy in copies:
+        if f"edep_mean_MeV_{copy}" not in new:
+            print(f"copy {copy}: no deposit in the new run")
+            continue
+        m_ref, m_new = float(ref[f"edep_mean_MeV_{copy}"]), float(new[f"edep_mean_MeV_{copy}"])
+        err = math.hypot(m_ref * float(ref[f"edep_relerr_{copy}"]), m_new * float(new[f"edep_relerr_{copy}"]))
+        pull = (m_new - m_ref) / err if err > 0 else 0.
+        print(f"copy {copy}: {pull:+.2f} sigma -> {'compatible' if abs(pull) < 3 else 'NOT compatible'}")
+
+    if "fom_worst" in ref and "fom_worst" in new:
+        saved = 1. - float(ref["fom_worst"]) / float(new["fom_worst"])
+        print(f"time saved at equal crystal-dose accuracy: {100. * saved:.1f} %")
@@ -9,11 +9,6 @@ import Analysis.config.config          as cfg
 from   Analysis.utils              import G4Tools, XTools
 from   Analysis.models.PDGParticle import PDGParticle_dict
 
-# Columns names from expeceted csv file
-column_names = ["fEvent", "fEntry", "fPreProc", "fPostProc", "fTrackID", 
-                "fParentID", "fPDG", "fKinetic", "fEdep", 
-                "fX1", "fY1", "fZ1", "fX2", "fY2", "fZ2", "Copy"]
-
 # Open json config file for this script and extract values
 try:
     with open('gen_sim_report.json', 'r') as file:
@@ -26,9 +21,6 @@ except FileNotFoundError:
 except json.JSONDecodeError:
     print("Error: Invalid JSON format in 'gen_sim_report.json'.")
 
-run_data_filepath     = f"{data_dir_filepath}/output0_nt_Hits.csv"
-gen_neutrons_filepath = f"{data_dir_filepath}/generated_neutrons.csv"
-gen_gammas_filepath   = f"{data_dir_filepath}/generated_gammas.csv"
 geo_params_filepath   = f"{data_dir_filepath}/geo_params.csv"
 
 # Create PDF
@@ -55,22 +47,24 @@ fig.text(0.1, 0.6, intro_text, ha="left", va="top", fontsize=11, wrap=True)
 pdf.savefig(fig)
 plt.close(fig)
 
-# Generate the run DataFrame
-df = G4Tools.gen_run_dataframe(run_data_filepath, column_names=column_names)
-df_n = pd.read_csv(gen_neutrons_filepath)
-df_g = pd.read_csv(gen_gammas_filepath)
+# Primaries table of run 0, in phx or csv format (the default
+# /phoenix/output/primaries all logs every event)
+df_prim = G4Tools.read_table(data_dir_filepath, "Primaries", run=0,
+                             columns=["fPDG", "fKinetic", "fDirX", "fDirY", "fDirZ"])
+df_n = df_prim[df_prim["fPDG"] == 2112]
+df_g = df_prim[df_prim["fPDG"] == 22]
 df_p = pd.read_csv(geo_params_filepath)
 
 fig,(ax1, ax2, ax3, ax4) = plt.subplots(ncols = 1, nrows=4, figsize=(8,8))
 
 fig.suptitle("Primaries Characteristion", fontsize = 20)
 
-energies_neutrons = np.array(df_n["E_MeV"])
-energies_gammas   = np.array(df_g["E_MeV"])
+energies_neutrons = np.array(df_n["fKinetic"])
+energies_gammas   = np.array(df_g["fKinetic"])
 
-dir_x_neutrons = np.array(df_n["dir_x"])
-dir_y_neutrons = np.array(df_n["dir_y"])
-dir_z_neutrons = np.array(df_n["dir_z"])
+dir_x_neutrons = np.array(df_n["fDirX"])
+dir_y_neutrons = np.array(df_n["fDirY"])
+dir_z_neutrons = np.array(df_n["fDirZ"])
 
 # Summary stats
 stats = {
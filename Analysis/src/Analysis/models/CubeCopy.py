@@ -16,4 +16,21 @@ CopyCube_dict = {
     2 : CubeCopy("Cube 2", (-100,0,196.1)) ,
     3 : CubeCopy("Cube 3", (0,-100,196.1))
 
-}
\ No newline at end of file
+}
+
+def decode_sweep_copy(copy):
+    """
+    CoCsCube sweep cubes (/MyCube/AddCube) encode their geometry in the copy
+    number as side*10000 + distance, both in units of 0.1 mm.
+    Returns (distance, side) in mm.
+    """
+    copy = int(copy)
+    return (copy % 10000) * 0.1, (copy // 10000) * 0.1
+
+
+def encode_sweep_copy(distance, side):
+    """
+    Copy number of a CoCsCube sweep cube at distance with the given side,
+    both in mm (MyDetectorConstruction::CubeCopyNumber).
+    """
+    return int(round(side / 0.1)) * 10000 + int(round(distance / 0.1))
@@ -1,3 +1,6 @@
+import os
+import struct
+
 import pandas as pd
 import numpy as np
 import matplotlib.pyplot as plt
@@ -7,21 +10,178 @@ from   Analysis.models.PDGParticle import PDGParticle_dict
 from   Analysis.models.CubeCopy    import CopyCube_dict
 
 
-def gen_run_dataframe(filepath : str, column_names : list, skiprows : int = 20) -> pd.DataFrame:
+def read_g4csv_header(filepath : str) -> tuple:
     """
-    Generate a pandas DataFrame from a CSV file.
+    Read the header of a Geant4 CSV ntuple: the '#' lines before the data,
+    among them one '#column <type> <name>' line per column.
 
     Parameters:
     filepath (str): Path to the CSV file.
-    column_names (list): List of column names for the DataFrame.
-    skiprows (int): Number of rows to skip at the start of the file.
+
+    Returns:
+    tuple: (column names, number of header lines).
+    """
+    names, nlines = [], 0
+    with open(filepath, "r") as f:
+        for line in f:
+            if not line.startswith("#"):
+                break
+            nlines += 1
+            if line.startswith("#column "):
+                names.append(line.split()[-1])
+    return names, nlines
+
+
+def gen_run_dataframe(filepath : str, column_names : list = None, skiprows : int = None) -> pd.DataFrame:
+    """
+    Generate a pandas DataFrame from a Geant4 CSV ntuple.
+
+    The column names and the header length are taken from the file's own
+    '#column' lines, so tables that gained a column (e.g. fWeight) load
+    without changes here.
+
+    Parameters:
+    filepath (str): Path to the CSV file.
+    column_names (list): Column names to check against the header (default: the header's).
+    skiprows (int): Number of rows to skip at the start of the file (default: the header lines).
 
     Returns:
     pd.DataFrame: The generated DataFrame.
     """
+    header_names, header_lines = read_g4csv_header(filepath)
+    if column_names is None:
+        column_names = header_names
+    elif header_names and list(column_names) != header_names:
+        raise ValueError(f"{filepath}: columns are {header_names}, not {list(column_names)}")
+    if skiprows is None:
+        skiprows = header_lines
     return pd.read_csv(filepath, skiprows=skiprows, sep=',', names=column_names)
 
 
+# PHXC column type codes -> numpy dtypes (None marks a string column)
+_PHX_DTYPES = {1: np.int8, 2: np.int16, 3: np.int32, 4: np.int64,
+               5: np.float32, 6: np.float64, 7: None}
+
+
+def read_phx(filepath : str, columns : list = None) -> pd.DataFrame:
+    """
+    Load a binary PHXC hit file written by the G4 simulations.
+
+    Only the payloads of the requested columns are read, so e.g.
+    read_phx(path, ["fEdep", "Copy"]) touches a small part of the file.
+
+    Parameters:
+    filepath (str): Path to the .phx file.
+    columns (list): Column names to load (default: all).
+
+    Returns:
+    pd.DataFrame: The requested columns.
+    """
+    with open(filepath, "rb") as f:
+        magic, version, ncols = struct.unpack("<4sII", f.read(12))
+        if magic != b"PHXC" or version != 1:
+            raise ValueError(f"{filepath}: not a PHXC v1 file")
+
+        schema = []
+        for _ in range(ncols):
+            ctype, nlen = struct.unpack("<BH", f.read(3))
+            schema.append((f.read(nlen).decode(), ctype))
+
+        names  = [n for n, _ in schema]
+        wanted = names if columns is None else list(columns)
+        chunks = {n: [] for n in wanted}
+
+        while True:
+            head = f.read(8)
+            if len(head) < 8:
+                break
+            nrows = struct.unpack("<4sI", head)[1]
+            sizes = struct.unpack(f"<{ncols}Q", f.read(8 * ncols))
+            start = f.tell()
+            offset = start
+            for (name, ctype), size in zip(schema, sizes):
+                if name in chunks:
+                    f.seek(offset)
+                    raw = f.read(size)
+                    dtype = _PHX_DTYPES[ctype]
+                    if dtype is None:
+                        lens  = np.frombuffer(raw[:4 * nrows], dtype=np.uint32)
+                        ends  = 4 * nrows + np.cumsum(lens)
+                        chunks[name].append([raw[e - l:e].decode() for l, e in zip(lens, ends)])
+                    else:
+                        chunks[name].append(np.frombuffer(raw, dtype=dtype))
+                offset += size
+            f.seek(offset)
+
+    data = {}
+    for name in wanted:
+        parts = chunks[name]
+        if parts and isinstance(parts[0], list):
+            data[name] = [s for p in parts for s in p]
+        else:
+            data[name] = np.concatenate(parts) if parts else np.array([])
+    return pd.DataFrame(data)
+
+
+def read_table(data_dir : str, table : str, run : int = 0, columns : list = None) -> pd.DataFrame:
+    """
+    Load one output table of a run, whatever /phoenix/output/format wrote:
+    output<run>_<table>.phx, else the CSV ntuple output<run>_nt_<table>.csv.
+
+    Parameters:
+    data_dir (str): Output directory of the simulation.
+    table (str): Table name, e.g. "Primaries", "Tracks" or "Hits".
+    run (int): Run number.
+    columns (list): Column names to load (default: all).
+
+    Returns:
+    pd.DataFrame: The requested columns.
+    """
+    phx = f"{data_dir}/output{run}_{table}.phx"
+    csv = f"{data_dir}/output{run}_nt_{table}.csv"
+    if os.path.exists(phx):
+        return read_phx(phx, columns)
+    if os.path.exists(csv):
+        df = gen_run_dataframe(csv)
+        return df if columns is None else df[list(columns)]
+    raise FileNotFoundError(f"no {table} table for run {run}: neither {phx} nor {csv} exists")
+
+
+def decode_processes(df : pd.DataFrame, table_path : str) -> pd.DataFrame:
+    """
+    Replace the integer fPreProc/fPostProc codes of a PHXC hit table with
+    process names, using the <run>_processes.csv side table of that run.
+
+    Parameters:
+    df (pd.DataFrame): Hit table from read_phx.
+    table_path (str): Path to the code,name side table.
+
+    Returns:
+    pd.DataFrame: The same DataFrame with process names.
+    """
+    table = pd.read_csv(table_path)
+    names = dict(zip(table["code"], table["name"]))
+    for col in ("fPreProc", "fPostProc"):
+        if col in df:
+            df[col] = df[col].map(names)
+    return df
+
+
+def read_hist(base : str) -> dict:
+    """
+    Load the summaries phoenix_hist writes for <base>, instead of loading
+    the hit tables themselves.
+
+    Parameters:
+    base (str): The -o argument of phoenix_hist.
+
+    Returns:
+    dict: DataFrames "spectra" (copy, bin, low, high, counts, sumw2),
+          "copies", "pdg" and "procs".
+    """
+    return {name: pd.read_csv(f"{base}_{name}.csv") for name in ("spectra", "copies", "pdg", "procs")}
+
+
 def get_unique_event_numbers(df : pd.DataFrame) -> np.ndarray:
     """
     Get an array of unique event numbers from the DataFrame.
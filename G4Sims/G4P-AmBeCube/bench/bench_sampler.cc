@@ -0,0 +1,111 @@
+// bench_sampler.cc
+// Draws/s of SpectrumSampler against the previous lower_bound + linear-CDF
+// sampler, on the built-in AmBe table. Also prints each sampler's mean
+// energy next to the exact mean of the piecewise-linear pdf.
+//
+// Usage: sampler_bench [nDraws]
+
+#include "SpectrumLibrary.hh"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace {
+
+// The sampler as it was: binary search over the CDF, then a linear
+// interpolation of E in the CDF (exact only for flat bins)
+class LegacySpectrumSampler {
+public:
+  LegacySpectrumSampler(std::vector<double> E, std::vector<double> w)
+  : E_(std::move(E)), w_(std::move(w)) {
+    const size_t n = E_.size();
+    C_.assign(n, 0.0);
+    for (size_t i=1;i<n;++i)
+      C_[i] = C_[i-1] + std::max(0.0, 0.5 * (w_[i-1] + w_[i]) * (E_[i] - E_[i-1]));
+    double total = C_.back();
+    for (auto &c : C_) c /= total;
+  }
+
+  double sample(double u) const {
+    if (u <= 0.0) return E_.front();
+    if (u >= 1.0) return E_.back();
+    auto it = std::lower_bound(C_.begin(), C_.end(), u);
+    size_t j = std::distance(C_.begin(), it);
+    if (j == 0) return E_.front();
+    double u0 = C_[j-1], u1 = C_[j];
+    double t  = (u - u0) / std::max(1e-16, (u1 - u0));
+    return E_[j-1] + t * (E_[j] - E_[j-1]);
+  }
+
+private:
+  std::vector<double> E_, w_, C_;
+};
+
+const std::vector<double> kEnergy(std::begin(Spectra::kAmBeEnergy), std::end(Spectra::kAmBeEnergy));
+const std::vector<double> kWeight(std::begin(Spectra::kAmBeWeight), std::end(Spectra::kAmBeWeight));
+
+// Exact mean of the piecewise-linear pdf through (E, w)
+double exactMean(const std::vector<double>& E, const std::vector<double>& w) {
+  double m = 0.0, a = 0.0;
+  for (size_t i=1;i<E.size();++i) {
+    double h = E[i] - E[i-1];
+    a += 0.5 * (w[i-1] + w[i]) * h;
+    m += h * (w[i-1] * (2*E[i-1] + E[i]) + w[i] * (E[i-1] + 2*E[i])) / 6.0;
+  }
+  return m / a;
+}
+
+template <typename F>
+double seconds(F&& f) {
+  auto t0 = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+double mean(const std::vector<double>& v) {
+  double s = 0.0;
+  for (double x : v) s += x;
+  return s / static_cast<double>(v.size());
+}
+
+}
+
+int main(int argc, char** argv) {
+
+  const size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+  std::vector<double> u(n), out(n);
+  std::mt19937_64 rng(12345);
+  std::uniform_real_distribution<double> uni(0.0, 1.0);
+  for (auto &x : u) x = uni(rng);
+
+  LegacySpectrumSampler legacy(kEnergy, kWeight);
+  SpectrumSampler       sampler(kEnergy, kWeight);
+
+  double tLegacy = seconds([&] { for (size_t k = 0; k < n; ++k) out[k] = legacy.sample(u[k]); });
+  double mLegacy = mean(out);
+
+  double tScalar = seconds([&] { for (size_t k = 0; k < n; ++k) out[k] = sampler.sample(u[k]); });
+  double mScalar = mean(out);
+
+  double tBatch  = seconds([&] { sampler.sample(u.data(), out.data(), n); });
+  double mBatch  = mean(out);
+
+  // The compile-time table the generator uses
+  const SpectrumView builtin = Spectra::kAmBe.view();
+  double tBuiltin = seconds([&] { for (size_t k = 0; k < n; ++k) out[k] = builtin.sample(u[k]); });
+  double mBuiltin = mean(out);
+
+  std::printf("sampler,draws,seconds,draws_per_s,ns_per_draw,mean_MeV\n");
+  std::printf("legacy,%zu,%.4f,%.4g,%.2f,%.5f\n", n, tLegacy, n / tLegacy, 1e9 * tLegacy / n, mLegacy);
+  std::printf("alias,%zu,%.4f,%.4g,%.2f,%.5f\n",  n, tScalar, n / tScalar, 1e9 * tScalar / n, mScalar);
+  std::printf("alias_batch,%zu,%.4f,%.4g,%.2f,%.5f\n", n, tBatch, n / tBatch, 1e9 * tBatch / n, mBatch);
+  std::printf("builtin,%zu,%.4f,%.4g,%.2f,%.5f\n", n, tBuiltin, n / tBuiltin, 1e9 * tBuiltin / n, mBuiltin);
+  std::printf("exact,,,,,%.5f\n", exactMean(kEnergy, kWeight));
+
+  return 0;
+}
@@ -0,0 +1,221 @@
+// phoenix_bench.cc
+// ns/op of the per-event and per-step hot paths, outside a run:
+//   spectrum_*        SpectrumView::sample on the built-in AmBe table
+//   generate_primaries MyPrimaryGenerator::GeneratePrimaries
+//   log_primaries     the same, plus the end-of-event Primaries row(s) in PHXC
+//   process_hits_*    MySensitiveDetector::ProcessHits on synthetic G4Steps
+//                     in a 1 cm LiF crystal, located by a real navigator;
+//                     *_steps_sync/async also write the per-step Hits table
+//                     (async: producer side, the drain at Close is not timed)
+// Each case is timed five times after a warm-up and the fastest is kept.
+// Output is CSV: benchmark,ops,ns_per_op
+//
+// Usage: phoenix_bench [scale]   (scale multiplies the number of ops, default 1)
+
+#include "G4Box.hh"
+#include "G4DynamicParticle.hh"
+#include "G4Electron.hh"
+#include "G4Event.hh"
+#include "G4Gamma.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Navigator.hh"
+#include "G4NistManager.hh"
+#include "G4Neutron.hh"
+#include "G4PVPlacement.hh"
+#include "G4SDManager.hh"
+#include "G4Step.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4TouchableHistory.hh"
+#include "G4Track.hh"
+#include "Randomize.hh"
+
+#include "MyHitWriter.hh"
+#include "MyPrimaryGenerator.hh"
+#include "MySensitiveDetector.hh"
+#include "MyVoxelScorer.hh"
+#include "SpectrumLibrary.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <vector>
+
+namespace {
+
+// Best of five timed repetitions of body(nOps), after one warm-up
+template <typename F>
+void report(const char* name, long nOps, F&& body) {
+  body(nOps / 10 + 1);
+  double best = 1e300;
+  for (int rep = 0; rep < 5; ++rep) {
+    auto t0 = std::chrono::steady_clock::now();
+    body(nOps);
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    best = std::min(best, s);
+  }
+  std::printf("%s,%ld,%.2f\n", name, nOps, 1e9 * best / nOps);
+}
+
+// Keeps the optimiser from dropping a result
+volatile double gSink = 0.;
+
+// World of air with one LiF crystal, as in the detector construction
+G4VPhysicalVolume* buildGeometry() {
+  G4NistManager* nist = G4NistManager::Instance();
+  auto logicWorld = new G4LogicalVolume(new G4Box("solid_World", 50*cm, 50*cm, 50*cm),
+                                        nist->FindOrBuildMaterial("G4_AIR"), "logic_World");
+  auto physWorld  = new G4PVPlacement(nullptr, G4ThreeVector(), logicWorld, "phys_World",
+                                      nullptr, false, 0);
+  auto logicCrystal = new G4LogicalVolume(new G4Box("solid_Crystal", 0.5*cm, 0.5*cm, 0.5*cm),
+                                          nist->FindOrBuildMaterial("G4_LITHIUM_FLUORIDE"),
+                                          "logic_Crystal");
+  new G4PVPlacement(nullptr, G4ThreeVector(0., 0., 10*cm), logicCrystal, "phys_Crystal0",
+                    logicWorld, false, 0);
+  return physWorld;
+}
+
+// A step of a neutron in the crystal; the caller owns the track
+struct SyntheticStep {
+  G4Step   step;
+  G4Track* track;
+
+  SyntheticStep(G4VPhysicalVolume* world, G4Navigator& navigator) {
+    G4ThreeVector pre (0.1*mm, -0.2*mm, 10*cm - 2*mm);
+    G4ThreeVector post(0.3*mm,  0.1*mm, 10*cm + 1*mm);
+
+    track = new G4Track(new G4DynamicParticle(G4Neutron::Definition(), G4ThreeVector(0, 0, 1), 2*MeV),
+                        0., pre);
+    track->SetTrackID(1);
+    track->SetParentID(0);
+    step.SetTrack(track);
+
+    navigator.SetWorldVolume(world);
+    navigator.LocateGlobalPointAndSetup(pre, nullptr, false, true);
+    G4TouchableHandle touchable(navigator.CreateTouchableHistory());
+
+    G4StepPoint* prePoint = step.GetPreStepPoint();
+    prePoint->SetPosition(pre);
+    prePoint->SetKineticEnergy(2*MeV);
+    prePoint->SetStepStatus(fGeomBoundary);
+    prePoint->SetTouchableHandle(touchable);
+    step.GetPostStepPoint()->SetPosition(post);
+    step.GetPostStepPoint()->SetTouchableHandle(touchable);
+    step.SetTotalEnergyDeposit(0.3*MeV);
+  }
+
+  ~SyntheticStep() { delete track; }
+};
+
+}
+
+int main(int argc, char** argv) {
+
+  const long scale = (argc > 1) ? std::max(1L, std::atol(argv[1])) : 1;
+
+  // Particles the generator and the steps use
+  G4Neutron::Definition();
+  G4Gamma::Definition();
+  G4Electron::Definition();
+
+  std::printf("benchmark,ops,ns_per_op\n");
+
+  // ---- Spectrum sampling ----
+  const SpectrumView spectrum = Spectra::kAmBe.view();
+  {
+    const long n = 4000000 * scale;
+    std::vector<double> u(n), out(n);
+    for (auto& x : u) x = G4UniformRand();
+
+    report("spectrum_scalar", n, [&](long m) {
+      double s = 0.;
+      for (long k = 0; k < m; ++k) s += spectrum.sample(u[k]);
+      gSink = s;
+    });
+    report("spectrum_batch", n, [&](long m) {
+      spectrum.sample(u.data(), out.data(), static_cast<size_t>(m));
+      gSink = out[m - 1];
+    });
+  }
+
+  // ---- Primary generation ----
+  namespace fs = std::filesystem;
+  const fs::path logDir = fs::temp_directory_path() / "phoenix_bench";
+  fs::create_directories(logDir);
+  {
+    MyPrimaryGenerator generator;
+    G4int eventID = 0;
+    report("generate_primaries", 200000 * scale, [&](long m) {
+      for (long k = 0; k < m; ++k) {
+        G4Event event(eventID++);
+        generator.GeneratePrimaries(&event);
+      }
+    });
+
+    MyHitWriter* writer = MyHitWriter::Instance();
+    writer->Open((logDir / "bench").string(), "");
+    report("log_primaries", 200000 * scale, [&](long m) {
+      for (long k = 0; k < m; ++k) {
+        G4Event event(eventID++);
+        generator.GeneratePrimaries(&event);
+        writer->FillPrimaries(&event);
+      }
+    });
+    writer->Close();
+  }
+  fs::remove_all(logDir);
+
+  // ---- Sensitive detector ----
+  G4VPhysicalVolume* world = buildGeometry();
+  G4Navigator navigator;
+  SyntheticStep synthetic(world, navigator);
+  G4Step* step = &synthetic.step;
+
+  auto sd = new MySensitiveDetector("CrystalSD");
+  G4SDManager* sdManager = G4SDManager::GetSDMpointer();
+  sdManager->AddNewDetector(sd);
+
+  // A fresh collection every 1000 tracks, as if each were an event; the
+  // collection is deleted with the G4HCofThisEvent
+  const long tracksPerEvent = 1000;
+  auto runSteps = [&](long m, G4bool newTrackEachStep) {
+    G4HCofThisEvent* hce = nullptr;
+    for (long k = 0; k < m; ++k) {
+      if (k % tracksPerEvent == 0) {
+        delete hce;
+        hce = new G4HCofThisEvent(sdManager->GetCollectionCapacity());
+        sd->Initialize(hce);
+      }
+      if (newTrackEachStep) synthetic.track->SetTrackID(static_cast<G4int>(k % tracksPerEvent) + 1);
+      sd->Hit(step);
+    }
+    delete hce;
+  };
+
+  const long nSteps = 2000000 * scale;
+  report("process_hits_same_track", nSteps, [&](long m) { runSteps(m, false); });
+  report("process_hits_new_track",  nSteps, [&](long m) { runSteps(m, true); });
+
+  MyVoxelScorer::Instance()->SetGrid(10, 10, 10);
+  MyVoxelScorer::Instance()->SetActive(true);
+  report("process_hits_voxels", nSteps, [&](long m) { runSteps(m, false); });
+  MyVoxelScorer::Instance()->SetActive(false);
+
+  // Per-step Hits rows, written on this thread and through the writer thread
+  fs::create_directories(logDir);
+  MyHitWriter* writer = MyHitWriter::Instance();
+  writer->SetWriteSteps(true);
+  for (G4bool async : {false, true}) {
+    writer->SetAsync(async);
+    writer->Open((logDir / "bench").string(), "");
+    report(async ? "process_hits_steps_async" : "process_hits_steps_sync", nSteps,
+           [&](long m) { runSteps(m, false); });
+    writer->Close();
+  }
+  writer->SetWriteSteps(false);
+  fs::remove_all(logDir);
+
+  return 0;
+}
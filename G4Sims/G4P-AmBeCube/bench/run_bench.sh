@@ -0,0 +1,23 @@
+#!/bin/bash
+# Builds the benchmarks in Release mode, runs them and records their output
+# with the machine, toolchain and commit in bench/results/<host>_<date>.txt.
+# Arguments are passed to phoenix_bench (scale).
+
+set -e
+cd "$(dirname "$0")/.."
+
+cmake -S . -B build-bench -DCMAKE_BUILD_TYPE=Release
+cmake --build build-bench -j"$(nproc)" --target sampler_bench phoenix_bench
+
+mkdir -p bench/results
+out=bench/results/$(hostname -s)_$(date +%Y%m%d).txt
+{
+    echo "# $(date -Iseconds) on $(hostname -s), commit $(git rev-parse --short HEAD)"
+    echo "# cpu: $(lscpu | sed -n 's/^Model name: *//p'), $(nproc) cores"
+    echo "# compiler: $(${CXX:-c++} --version | head -1)"
+    echo "# geant4: $(geant4-config --version 2>/dev/null || echo unknown)"
+    ./build-bench/sampler_bench
+    ./build-bench/phoenix_bench "$@"
+} | tee "$out"
+
+echo "Recorded in $out"
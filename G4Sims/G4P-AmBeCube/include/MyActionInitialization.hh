@@ -10,6 +10,7 @@ class MyActionInitialization : public G4VUserActionInitialization {
         MyActionInitialization(const G4String& outputPath = "./");
         ~MyActionInitialization();
 
+        virtual void BuildForMaster() const;
         virtual void Build() const;
 
     private:
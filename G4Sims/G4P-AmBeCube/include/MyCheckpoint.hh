@@ -0,0 +1,114 @@
+#ifndef MY_CHECKPOINT_HH
+#define MY_CHECKPOINT_HH
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "globals.hh"
+
+class G4Event;
+class G4Run;
+
+// Checkpoint/resume of long sequential runs. With /phoenix/checkpoint/every
+// N, the state after every N-th event goes to <outputDir>/checkpoint/:
+//   checkpoint.csv - run ID, next event, and the size of each output table
+//                    once its queued rows are flushed (MyHitWriter::Flush)
+//   rng.state      - the engine status (G4Random::saveEngineStatus)
+//   voxels.bin     - the voxel grids, if scored (MyVoxelScorer::Save)
+//   h1_*, h2_*.csv - the online histograms, if filled (MyHistograms::Save)
+//   summary.bin    - the run summary sums (MyRunSummary::Save); the run's
+//                    wall time so far is in checkpoint.csv
+//   profile.csv    - the step profile, if active (MyStepProfiler::Save)
+// and, when a PhaseSpace table is replayed, its cursor in checkpoint.csv.
+// A checkpoint is also taken at the start and the end of every run. The
+// directory is replaced by a rename, so a crash leaves the previous one.
+//
+// Started again with --resume and the same macro (MyResumeRunManager),
+// runs completed before the crash are skipped without a /run/beamOn. The
+// interrupted run reopens its tables at the saved sizes, restores the
+// engine, the replay cursor, the grids, the histograms, the summary and the
+// profile, and runs only the remaining events, whose IDs continue from the
+// checkpoint. The rows and sums then match an uninterrupted run bit for
+// bit; the profile times and the summary's wall time are the sums of both
+// processes'.
+//
+// Sequential mode and PHXC output only: with worker threads the event
+// order, and so the engine state per event, is not reproducible.
+class MyCheckpoint {
+    public:
+        static MyCheckpoint* Instance();
+
+        void SetDirectory(const G4String& dir) { fDirectory = dir; }
+        void SetResume(G4bool value) { fResume = value; }
+        void SetInterval(G4int nEvents) { fInterval = nEvents; }
+
+        // Resume run manager, before the /run/beamOn of run runID, whose
+        // nEvents events start at ID eventBase (a --jobs share). usable is
+        // false with CSV output. Returns the event to start from, or -1 if
+        // the whole run was done before the restart and must be skipped.
+        G4int BeginOfBeamOn(G4int runID, G4int nEvents, G4int eventBase, G4bool usable);
+        // Master, begin of run, after the accumulables are reset. usable is
+        // false in MT mode or with CSV output. Restores the grids, the
+        // histograms, the summary and the profile of an interrupted run.
+        void BeginOfRun(const G4Run* run, G4bool usable);
+        // After the outputs are opened: the checkpoint of the run start
+        void Start();
+        // End of event: a checkpoint every N events
+        void EndOfEvent(const G4Event* event);
+        // Master, end of run, after the outputs are closed
+        void EndOfRun();
+
+        // Events of this run done before the restart, and not run again
+        G4int GetFirstEvent() const { return fFirstEvent; }
+        // Table sizes to reopen the outputs at; empty for a fresh run
+        const std::vector<std::uint64_t>& GetOutputOffsets() const { return fOffsets; }
+
+    private:
+        MyCheckpoint();
+
+        struct Saved {
+            G4String dir;
+            G4int    run        = -1;
+            G4int    nextEvent  = 0;
+            G4int    total      = 0;
+            G4bool   voxels     = false;
+            G4bool   histograms = false;
+            G4bool   profile    = false;
+            G4double seconds    = 0.;
+            // Replay cursor (MyPhaseSpaceSource); empty path: no replay
+            G4String      phaseSpace;
+            std::uint64_t phaseSpaceNext  = 0;
+            std::size_t   phaseSpaceGroup = 0;
+            G4int         phaseSpaceUses  = 0;
+            std::vector<std::uint64_t> offsets;
+        };
+
+        void   Save(G4int nextEvent);
+        // The newest complete checkpoint in fDirectory
+        G4bool Read(Saved& saved) const;
+        // The engine and the replay cursor as they were saved
+        G4bool RestoreEngine(const Saved& saved) const;
+
+        G4String fDirectory;
+        G4bool   fResume;
+        G4int    fInterval;
+
+        // This run
+        G4bool fActive;
+        G4bool fPrepared;    // BeginOfBeamOn was called for it
+        G4bool fRestore;     // continues from fSaved
+        G4int  fRunID;
+        G4int  fTotal;       // events of the whole /run/beamOn
+        G4int  fEventBase;   // ID of the run's first event (a --jobs share)
+        G4int  fFirstEvent;  // counted from fEventBase
+        std::vector<std::uint64_t> fOffsets;
+        // Wall time of the run: before the restart, and since Start()
+        G4double fSecondsBefore;
+        std::chrono::steady_clock::time_point fStartTime;
+
+        // The checkpoint being resumed from
+        Saved fSaved;
+};
+
+#endif
@@ -17,6 +17,11 @@
 #include "G4Colour.hh"
 #include "G4VisAttributes.hh"
 
+#include <utility>
+#include <vector>
+
+#include "G4SDManager.hh"
+
 #include "MySensitiveDetector.hh"
 
 using std::vector;
@@ -29,11 +34,34 @@ class MyDetectorConstruction : public G4VUserDetectorConstruction {
 
         virtual G4VPhysicalVolume *Construct(); 
 
+        // Between runs (/phoenix/geometry/): move daughters of the lab in
+        // place instead of rebuilding the detector. Only the lab's
+        // voxelisation is rebuilt, the physics tables are kept, and only
+        // the moved volumes are checked for overlaps; a move that overlaps
+        // is undone. crystalDistance and blockGap write geo_params.csv again,
+        // and are kept by a later /run/reinitializeGeometry; before
+        // /run/initialize they only set the layout to build.
+        void SetCrystalDistance(G4double distance);  // crystals at +-d on x and y
+        void SetBlockGap(G4double gap);              // PLY blocks to source shield
+        void MoveVolume(G4String args);              // "<physical volume> x y z unit"
+
+        // Worker threads, begin of run: every worker keeps its own copy of
+        // each placement, taken from the master when the thread starts;
+        // this sets the positions moved on the master since then
+        static void ApplyMoves();
+
     private:
 
         static map<G4String, G4double> m_hGeoParams;
         G4String fOutputDirectory;
 
+        // Placements moved since the geometry was built; written by the
+        // master between runs only
+        static map<G4VPhysicalVolume*, G4ThreeVector> m_hMoved;
+        // crystalDistance and blockGap for Construct(); negative: default
+        G4double fCrystalDistance;
+        G4double fBlockGap;
+
         // Save geometry parameters to CSV (written to fOutputDirectory)
         void SaveGeoParamsToCSV() const;
 
@@ -51,10 +79,23 @@ class MyDetectorConstruction : public G4VUserDetectorConstruction {
         void ConstructCrystals();
         void ConstructPLYBlocks();
 
+        // Production-cut regions (cuts are set by MyPhysicsList):
+        //   Crystals     - the LiF crystals, where dose is scored
+        //   SourceShield - the Pb source shield
+        //   Structure    - concrete floor and Al frame
+        // The wheel and PLY blocks, next to the crystals, keep the default cut
+        void DefineRegions();
+
         virtual void ConstructSDandField();
+
+        // Places the volumes, all daughters of logic_Lab, at the given
+        // positions within one open/close cycle of the lab; false if one
+        // of them overlaps (nothing is moved then)
+        G4bool Move(const vector<std::pair<G4VPhysicalVolume*, G4ThreeVector>>& moves);
                     
         /* Messenger variables */
         G4GenericMessenger *fMessengerCube;
+        G4int fOverlapPoints;  // points per moved volume, 0 skips the check
 
         /* Lab */
         G4Box*             solid_Lab;
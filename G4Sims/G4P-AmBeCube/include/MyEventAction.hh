@@ -1,8 +1,16 @@
 #ifndef MY_EVENT_ACTION_HH
 #define MY_EVENT_ACTION_HH
 
+#include <vector>
+
 #include "G4UserEventAction.hh"
+#include "globals.hh"
 
+// Reduces the crystal hits collection of each event to the Tracks,
+// Deposits and Events tables of MyHitWriter, and logs the event's
+// primaries according to /phoenix/output/primaries. Adds the crystal
+// deposits to MyRunSummary. Then gives MyCheckpoint its chance to save
+// the state.
 class MyEventAction : public G4UserEventAction {
     public:
         MyEventAction();
@@ -10,6 +18,22 @@ class MyEventAction : public G4UserEventAction {
 
         virtual void BeginOfEventAction(const G4Event *anEvent);
         virtual void EndOfEventAction(const G4Event *anEvent);
+
+    private:
+        void Record(const G4Event *anEvent);
+
+        G4int fHCID;
+
+        // Per-event sums for each (copy, particle); reused between events
+        struct Deposit {
+            G4int    copyNo;
+            G4int    pdg;
+            G4double edep;
+            G4double wEdep;
+            G4int    nTracks;
+        };
+        std::vector<Deposit> fDeposits;
+        std::vector<G4int>   fCopies;
 };
 
 
@@ -0,0 +1,70 @@
+#ifndef MY_HISTOGRAMS_HH
+#define MY_HISTOGRAMS_HH
+
+#include <vector>
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+class G4Step;
+
+// Spectra filled during the run through the G4AnalysisManager, so they need
+// neither the Hits table nor offline post-processing:
+//   H2 EdepCopy            - deposit of an event in a crystal copy (x: copy,
+//                            y: MeV), weighted by the deposit's mean weight
+//   H1 EntryKinetic_<name> - kinetic energy (MeV) of tracks entering a
+//                            crystal, per species, weighted by track weight
+//   H2 DepthEdep           - deposit of a step versus its depth (mm) from
+//                            the crystal face towards the source axis
+// Every thread fills its own; the analysis manager adds the workers' into
+// the master's at end of run, which writes output<run>_h1_<name>.csv and
+// output<run>_h2_<name>.csv (G4 CSV histograms).
+class MyHistograms {
+    public:
+        static MyHistograms* Instance();
+
+        // Run action constructor, every thread: creates the histograms with
+        // their default binning
+        void Book();
+
+        void SetActive(G4bool value) { fActive = value; }
+        G4bool IsActive() const { return fActive; }
+
+        // Begin of run, every thread: binning as (bins, min, max) in MeV or
+        // mm; the kinetic energy axis is logarithmic
+        void Configure(const G4ThreeVector& edep, const G4ThreeVector& kinetic, const G4ThreeVector& depth);
+
+        // End of event: per copy, and per hit that entered through a face
+        void FillDeposit(G4int copyNo, G4double edep, G4double wEdep);
+        void FillEntry(G4int pdg, G4double kinetic, G4double weight);
+        // Sensitive detector, per step with a deposit
+        void FillStep(const G4Step* step);
+
+        // Checkpoint (MyCheckpoint): every histogram as a G4 CSV file in dir,
+        // read back through the G4CsvAnalysisReader. Load fails on a
+        // histogram missing from dir or of another binning.
+        void Save(const G4String& dir) const;
+        G4bool Load(const G4String& dir);
+
+        // "h1_<name>", "h2_<name>": the file of a histogram is
+        // <run base>_<tag>.csv
+        static std::vector<G4String> FileTags();
+
+        // Sums G4 CSV histogram files of independent jobs (same binning) bin
+        // by bin into one; false if none of the parts exists
+        static G4bool MergeFiles(const G4String& target, const std::vector<G4String>& parts);
+
+    private:
+        MyHistograms();
+
+        // Species with an entry spectrum of their own; the last is the rest
+        static constexpr G4int kNSpecies = 6;
+        static G4int Species(G4int pdg);
+
+        G4bool fActive;
+        G4int  fEdepCopyID;
+        G4int  fEntryID[kNSpecies];
+        G4int  fDepthEdepID;
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef MY_HIT_WRITER_HH
+#define MY_HIT_WRITER_HH
+
+#include <type_traits>
+
+#include "G4AnalysisManager.hh"
+#include "G4Event.hh"
+#include "G4String.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include "AsyncColumnWriter.hh"
+#include "ColumnFile.hh"
+#include "MyCrystalHit.hh"
+
+// Thread-local sink for the output tables:
+//   Hits     - raw step rows (debug, opt-in with /phoenix/output/steps)
+//   Tracks   - one row per track and crystal copy with summed deposits
+//   Deposits - per event, summed deposit per (copy, particle)
+//   Events   - one summary row per event with crystal hits
+//   Primaries - the primaries of each kept event (see PrimaryLog), read
+//              back from the G4Event at end of event; fEvent joins them
+//              to the other tables
+//   PhaseSpace - particles leaving the phase-space surface, only while
+//              recording (MyPhaseSpaceRecorder); input of MyPhaseSpaceSource
+// Every table carries the importance-biasing weight: fWeight per step or
+// track, and the weighted deposit sum fWEdep for the aggregates.
+// While PHXC files are open the rows go to the binary columnar writers,
+// otherwise they are forwarded to the G4AnalysisManager CSV ntuples booked
+// by BookNtuples() (ntuple ID = table). Processes are passed as
+// MyProcessDictionary codes; the CSV Hits ntuple gets the names back.
+// PHXC rows are encoded and written on the transport thread. With async
+// output (/phoenix/output/async true), they are queued to a writer thread
+// per transport thread (AsyncColumnWriter) instead.
+class MyHitWriter {
+    public:
+        enum Table { kHits = 0, kTracks, kDeposits, kEvents, kPrimaries, kPhaseSpace, kNTables };
+
+        // Which events get their primaries logged
+        enum PrimaryLog { kLogNone = 0, kLogHit, kLogAll };
+        static PrimaryLog ParsePrimaryLog(const G4String& mode);
+
+        static MyHitWriter* Instance();
+        ~MyHitWriter();
+
+        static const char* TableName(G4int table);
+        static std::vector<ColumnSpec> Schema(G4int table);
+        static void BookNtuples();
+
+        // Opens <base>_<Table><suffix>.phx for every enabled table. A table
+        // with a non-zero resumeAt offset (from Flush) is reopened and
+        // continued from there instead of being recreated.
+        void Open(const G4String& base, const G4String& suffix,
+                  const std::vector<std::uint64_t>& resumeAt = {});
+        // Writes out every queued row; returns the file size per table (0
+        // for tables that are not open)
+        std::vector<std::uint64_t> Flush();
+        void Close();
+        G4bool IsOpen() const { return IsBinary(kTracks); }
+
+        // Takes effect at the next Open()
+        void   SetAsync(G4bool value) { fUseAsync = value; }
+
+        void   SetWriteSteps(G4bool value) { fWriteSteps = value; }
+        G4bool GetWriteSteps() const { return fWriteSteps; }
+
+        void       SetPrimaryLog(PrimaryLog value) { fPrimaryLog = value; }
+        PrimaryLog GetPrimaryLog() const { return fPrimaryLog; }
+
+        void   SetPhaseSpace(G4bool value) { fPhaseSpace = value; }
+
+        void FillStep(G4int evt, G4bool isEntry,
+                      G4int preProc, G4int postProc,
+                      G4int trackID, G4int parentID, G4int pdg,
+                      G4double kinetic, G4double edep,
+                      const G4ThreeVector& prePos, const G4ThreeVector& postPos,
+                      G4int copyNo, G4double weight);
+        void FillTrack(G4int evt, const MyCrystalHit* hit);
+        void FillDeposit(G4int evt, G4int copyNo, G4int pdg, G4double edep, G4double wEdep, G4int nTracks);
+        void FillEvent(G4int evt, G4int nTracks, G4int nCopies, G4double edep, G4double wEdep);
+        void FillPrimaries(const G4Event* event);
+        void FillPhaseSpace(G4int evt, G4int pdg, const G4ThreeVector& pos, const G4ThreeVector& dir,
+                            G4double kinetic, G4double weight, G4double time);
+
+    private:
+        MyHitWriter();
+
+        // Close() with errors reported at the given severity
+        void CloseWriters(G4ExceptionSeverity severity);
+
+        G4bool IsBinary(G4int table) const {
+            return fAsync ? fAsyncTable[table] >= 0 : fWriters[table] != nullptr;
+        }
+
+        // One column of the current row of a table, on whichever backend is open
+        template <typename T>
+        void Put(G4int table, G4int col, T value) {
+            if (fAsync)          { fAsync->fill<T>(fAsyncTable[table], col, value); return; }
+            if (fWriters[table]) { fWriters[table]->fill<T>(col, value); return; }
+            if (std::is_floating_point<T>::value)
+                G4AnalysisManager::Instance()->FillNtupleDColumn(table, col, value);
+            else
+                G4AnalysisManager::Instance()->FillNtupleIColumn(table, col, static_cast<G4int>(value));
+        }
+        void AddRow(G4int table);
+
+        ColumnWriter* fWriters[kNTables];
+        // Async backend: one writer thread for all tables of this thread
+        AsyncColumnWriter* fAsync;
+        G4int  fAsyncTable[kNTables];  // table index in fAsync, -1 if not open
+        G4bool fUseAsync;
+        G4bool fWriteSteps;
+        PrimaryLog fPrimaryLog;
+        G4bool fPhaseSpace;
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef MY_JOB_LAUNCHER_HH
+#define MY_JOB_LAUNCHER_HH
+
+#include "globals.hh"
+
+// --jobs K: runs the macro in K forked processes and merges what they write.
+// Job j writes to <outputDir>/job<j>/ (its console output to job.log there)
+// through a MyJobRunManager, which gives it a share of every /run/beamOn, its
+// own random stream and event IDs following those of job j-1. Once all jobs
+// have succeeded, the parent merges into <outputDir>/, per run:
+//   output<run>_<Table>.phx, or output<run>_nt_<Table>.csv - concatenated
+//       in job order, so fEvent stays sorted
+//   output<run>_Voxels.phx - summed voxel by voxel
+//   output<run>_h1_*.csv, output<run>_h2_*.csv - summed bin by bin
+//   output<run>_processes.csv, geo_params.csv - the same in every job; job 0's
+// Step profiles, phase-space info and checkpoints stay in the job directories.
+class MyJobLauncher {
+    public:
+        // Forks the jobs, before any Geant4 state exists. Returns the job
+        // number in a child, -1 in the parent.
+        static G4int Fork(const G4String& outputDir, G4int nJobs);
+        // Parent: waits for every job; false if one failed or could not start
+        static G4bool Wait();
+        // Parent: merges the job directories into outputDir
+        static G4bool Merge(const G4String& outputDir, G4int nJobs);
+
+        static G4String JobDirectory(const G4String& outputDir, G4int job);
+};
+
+#endif
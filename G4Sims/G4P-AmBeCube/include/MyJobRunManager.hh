@@ -0,0 +1,31 @@
+#ifndef MY_JOB_RUN_MANAGER_HH
+#define MY_JOB_RUN_MANAGER_HH
+
+#include "MyResumeRunManager.hh"
+
+// Sequential run manager of job `job` of a --jobs K launch (MyJobLauncher).
+// Every /run/beamOn N runs this job's share of the N events only. The job
+// gets its own random stream, and its event IDs continue those of the jobs
+// before it, so the merged tables have unique, ordered fEvent values. A
+// --resume continues each job from its own checkpoint.
+class MyJobRunManager : public MyResumeRunManager {
+    public:
+        MyJobRunManager(G4int job, G4int nJobs);
+
+        // The job run manager, nullptr outside a --jobs launch
+        static MyJobRunManager* Instance();
+
+        virtual void BeamOn(G4int nEvents, const char* macroFile = nullptr, G4int nSelect = -1);
+
+        G4int GetJob() const { return fJob; }
+        G4int GetNumberOfJobs() const { return fNJobs; }
+
+    private:
+        // Reseeds from the engine as the macro left it, plus the job number
+        void SeedJob();
+
+        G4int fJob;
+        G4int fNJobs;
+};
+
+#endif
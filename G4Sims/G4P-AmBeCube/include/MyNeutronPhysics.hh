@@ -0,0 +1,30 @@
+#ifndef MY_NEUTRON_PHYSICS_HH
+#define MY_NEUTRON_PHYSICS_HH
+
+#include "G4VPhysicsConstructor.hh"
+#include "globals.hh"
+
+// Hadronic physics for the "fast" profile of MyPhysicsList: only neutrons
+// get hadronic processes, and only the data-driven ParticleHP models below
+// 20 MeV (elastic, inelastic, capture), which cover the whole AmBe
+// spectrum. Charged recoils and capture products (p, d, t, alpha, ions)
+// only need EM physics at these energies, so no hadronic process is built
+// for them or for any other species.
+//
+// With useGeneralProcess the three processes are wrapped in one
+// G4NeutronGeneralProcess, which samples the interaction from tabulated
+// total cross sections per material.
+class MyNeutronPhysics : public G4VPhysicsConstructor {
+    public:
+        explicit MyNeutronPhysics(G4bool useGeneralProcess = false);
+
+        void SetGeneralProcess(G4bool value) { fUseGeneralProcess = value; }
+
+        virtual void ConstructParticle();
+        virtual void ConstructProcess();
+
+    private:
+        G4bool fUseGeneralProcess;
+};
+
+#endif
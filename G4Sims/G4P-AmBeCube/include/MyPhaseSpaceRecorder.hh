@@ -0,0 +1,48 @@
+#ifndef MY_PHASE_SPACE_RECORDER_HH
+#define MY_PHASE_SPACE_RECORDER_HH
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+class G4Step;
+
+// First stage of a two-stage simulation: every track that leaves a closed
+// surface around the source is written to the PhaseSpace table of
+// MyHitWriter (species, position, direction, energy, weight, time) and
+// killed, so nothing outside the surface is transported. The surface is
+// the outer bounding cylinder, about z, of a physical volume placed
+// unrotated in the world (by default phys_SourceShield, whose outline is
+// that cylinder). MyPhaseSpaceSource replays the table in later runs.
+//
+// One instance per thread; configured by MyRunAction at begin of run.
+class MyPhaseSpaceRecorder {
+    public:
+        static MyPhaseSpaceRecorder* Instance();
+
+        void   SetActive(G4bool value) { fActive = value; }
+        G4bool IsActive() const { return fActive; }
+
+        // Finds the surface of the given volume; false (and inactive) if
+        // the volume does not exist
+        G4bool Configure(const G4String& volume);
+
+        // From the stepping action, only when active
+        void Step(const G4Step* step);
+
+        G4double GetRadius() const { return fRadius; }
+        G4double GetHalfZ() const { return fHalfZ; }
+        const G4ThreeVector& GetCentre() const { return fCentre; }
+
+    private:
+        MyPhaseSpaceRecorder();
+
+        // Inside the cylinder grown by margin (shrunk if negative)
+        G4bool Inside(const G4ThreeVector& pos, G4double margin) const;
+
+        G4bool        fActive;
+        G4ThreeVector fCentre;
+        G4double      fRadius;
+        G4double      fHalfZ;
+};
+
+#endif
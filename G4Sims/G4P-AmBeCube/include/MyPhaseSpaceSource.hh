@@ -0,0 +1,57 @@
+#ifndef MY_PHASE_SPACE_SOURCE_HH
+#define MY_PHASE_SPACE_SOURCE_HH
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "globals.hh"
+
+class G4Event;
+
+// Second stage of a two-stage simulation: replays a PhaseSpace table
+// written by MyPhaseSpaceRecorder. Each event is one recorded source event,
+// i.e. all particles it sent through the surface, turned by a random angle
+// about z (the source and shield are symmetric about it). Every source
+// event is used `recycle` times in a row, each time with a new angle,
+// before moving to the next; the events are handed out to the threads from
+// one shared sequence, which starts over (with a warning) when exhausted.
+//
+// The table is loaded once per process and shared by all threads. Job j of
+// a --jobs K launch starts at source event j*G/K of the G in the table.
+class MyPhaseSpaceSource {
+    public:
+        // Throws std::runtime_error if the table cannot be read
+        explicit MyPhaseSpaceSource(const G4String& path);
+
+        void  SetRecycle(G4int n) { fRecycle = n > 0 ? n : 1; }
+        G4int GetRecycle() const { return fRecycle; }
+
+        void GeneratePrimaries(G4Event* event);
+
+        // Source events with at least one particle through the surface
+        std::size_t GetNumberOfGroups() const;
+
+        // Replay position, for checkpoints of sequential runs: the next
+        // group of the shared sequence, the current group and its uses
+        const G4String& GetPath() const { return fTable->path; }
+        void GetCursor(std::uint64_t& next, std::size_t& group, G4int& uses) const;
+        void SetCursor(std::uint64_t next, std::size_t group, G4int uses);
+
+        // Shared, read-only after loading (the cursor aside)
+        struct Table {
+            G4String path;
+            std::vector<std::int32_t> pdg;
+            std::vector<double> x, y, z, dirX, dirY, dirZ, kinetic, weight, time;
+            std::vector<std::size_t> groupStart;  // row of each source event, plus the end
+            std::atomic<std::uint64_t> next{0};   // next group to hand out, over all threads
+        };
+
+    private:
+        Table      *fTable;
+        G4int       fRecycle;
+        std::size_t fGroup;  // current group
+        G4int       fUses;   // times it has been used
+};
+
+#endif
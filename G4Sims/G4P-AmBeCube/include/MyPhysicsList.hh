@@ -1,18 +1,80 @@
 #ifndef MY_PHYSICS_LIST_HH
 #define MY_PHYSICS_LIST_HH
 
+#include <chrono>
+#include <map>
+
 #include "G4VModularPhysicsList.hh"
 #include "G4EmStandardPhysics.hh"
 #include "G4DecayPhysics.hh" // neutron recoil and capture processes
 #include "G4HadronElasticPhysicsHP.hh"
 #include "G4HadronPhysicsQGSP_BIC_HP.hh"
 #include "G4NeutronTrackingCut.hh"
+#include "G4GenericMessenger.hh"
+
+class G4GeometrySampler;
+class MyNeutronPhysics;
 
 class MyPhysicsList : public G4VModularPhysicsList{
     public:
         MyPhysicsList();
         ~MyPhysicsList();
 
+        virtual void ConstructParticle();
+        virtual void ConstructProcess();
+
+        // Physics profile (before /run/initialize):
+        //   reference - QGSP_BIC_HP hadronic physics for all hadrons
+        //   fast      - MyNeutronPhysics (neutron ParticleHP only) and the
+        //               gamma general process
+        void SetProfile(G4String profile);
+        const G4String& GetProfile() const { return fProfile; }
+        // Fast profile only: wrap the neutron processes in G4NeutronGeneralProcess
+        void SetNeutronGeneralProcess(G4bool value);
+
+        // Master: wall time from the start of ConstructProcess, i.e. of
+        // the physics part of /run/initialize, until now
+        G4double GetInitSeconds() const;
+
+        // Default cuts, the region cuts, then the warm-start cache lookup
+        // (MyPhysicsCache)
+        virtual void SetCuts();
+
+        // Production cut of a region of MyDetectorConstruction (Crystals,
+        // SourceShield, Structure)
+        void SetRegionCut(const G4String& region, G4double cut);
+
+        // Neutron importance of a physical volume of MyDetectorConstruction
+        // (e.g. phys_PLYWheel); the first call enables importance biasing
+        void SetImportance(G4String volume, G4double importance);
+
+    private:
+        G4String fProfile;
+        // Both sets are kept; only the active one is registered
+        G4VPhysicsConstructor *fHadronElastic;
+        G4VPhysicsConstructor *fHadronInelastic;
+        MyNeutronPhysics      *fNeutronPhysics;
+        G4GenericMessenger    *fMessengerPhysics;
+        std::chrono::steady_clock::time_point fInitStart;
+
+        // Geometry importance sampling of neutrons on the mass world: at a
+        // boundary from importance i1 into i2, a neutron is split into i2/i1
+        // copies or rouletted, with its weight scaled accordingly. Volumes
+        // not listed keep importance 1.
+        std::map<G4String, G4double> fImportance;
+        G4GeometrySampler  *fSampler;
+        G4GenericMessenger *fMessenger;
+
+        // Range cut per region; regions not listed use the default cut
+        std::map<G4String, G4double> fRegionCuts;
+        G4GenericMessenger *fMessengerCuts;
+
+        void SetCrystalsCut(G4double cut)     { SetRegionCut("Crystals", cut); }
+        void SetSourceShieldCut(G4double cut) { SetRegionCut("SourceShield", cut); }
+        void SetStructureCut(G4double cut)    { SetRegionCut("Structure", cut); }
+
+        void CreateImportanceStore() const;
+        void ApplyRegionCuts() const;
 };
 
 #endif
@@ -1,29 +1,50 @@
 #ifndef MY_PRIMARY_GENERATOR_HH
 #define MY_PRIMARY_GENERATOR_HH
 
-#include <fstream>
 #include "G4VUserPrimaryGeneratorAction.hh"
 #include "G4ParticleGun.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4ParticleTable.hh"
 #include "G4IonTable.hh"
 #include "G4RandomTools.hh"
+#include "G4GenericMessenger.hh"
+
+#include "SpectrumLibrary.hh"
+
+class MyPhaseSpaceSource;
 
 class MyPrimaryGenerator : public G4VUserPrimaryGeneratorAction{
     
     public:
-    MyPrimaryGenerator(const G4String& outputPath = "./");
+    MyPrimaryGenerator();
         ~MyPrimaryGenerator();
 
+    // The primaries stay in the G4Event; MyEventAction logs them at end of
+    // event if the event is kept (/phoenix/output/primaries)
     virtual void GeneratePrimaries(G4Event*);
 
+    // Neutron spectrum: a built-in name (AmBe, Cf252) or a CSV/binary file
+    void SetSpectrum(G4String nameOrPath);
+
+    // Replay a recorded PhaseSpace table instead of the source ("none"
+    // returns to the source), each source event `recycle` times
+    void SetPhaseSpace(G4String path);
+    void SetRecycle(G4int recycle);
+    // nullptr when the source itself is simulated
+    MyPhaseSpaceSource* GetPhaseSpace() const { return fPhaseSpace; }
+
     private:
         G4ParticleGun *fNeutronGun;
         G4ParticleGun *fGammaGun;
 
-    std::ofstream fOutNeutron;
-    std::ofstream fOutGamma;
-    G4String fOutputDirectory;
+        // Tables are shared (built-in or loaded once per process)
+        SpectrumView fSpectrum;
+        G4String     fSpectrumName;
+
+        MyPhaseSpaceSource *fPhaseSpace;
+        G4int               fRecycle;
+
+        G4GenericMessenger *fMessengerSource;
 };
 
 #endif
@@ -0,0 +1,28 @@
+#ifndef MY_RESUME_RUN_MANAGER_HH
+#define MY_RESUME_RUN_MANAGER_HH
+
+#include "G4RunManager.hh"
+
+// Sequential run manager of a --resume launch. Before every /run/beamOn it
+// asks MyCheckpoint where the run stands: a run completed before the
+// restart is skipped without an event loop, keeping the run IDs (and so the
+// output names) in step with the macro, and the interrupted run is started
+// with only its remaining events, whose IDs continue from the checkpoint.
+class MyResumeRunManager : public G4RunManager {
+    public:
+        MyResumeRunManager();
+
+        virtual void BeamOn(G4int nEvents, const char* macroFile = nullptr, G4int nSelect = -1);
+
+    protected:
+        virtual G4Event* GenerateEvent(G4int iEvent);
+
+        // Runs events eventBase .. eventBase + nEvents - 1 of the run, or
+        // what is left of them after a restart
+        void RunEvents(G4int nEvents, G4int eventBase, const char* macroFile, G4int nSelect);
+
+        // ID of the first event generated in the current run
+        G4int fEventOffset;
+};
+
+#endif
@@ -3,6 +3,11 @@
 
 #include "G4UserRunAction.hh"
 #include "G4Run.hh"
+#include "G4Timer.hh"
+#include "G4GenericMessenger.hh"
+#include "G4ThreeVector.hh"
+
+#include <vector>
 
 class MyRunAction : public G4UserRunAction{
 
@@ -15,9 +20,71 @@ class MyRunAction : public G4UserRunAction{
         
         void SetOutputDirectory(const G4String& dir) { outputDirectory = dir; }
         G4String GetOutputDirectory() const { return outputDirectory; }
+        // "phx" or "csv" (/phoenix/output/format)
+        const G4String& GetOutputFormat() const { return fOutputFormat; }
+
+        // Concatenate per-thread (or per-job) text files into one. The header
+        // is taken from the first part only: every leading '#' line for G4
+        // CSV ntuples, otherwise the first line. False if target could not
+        // be written in full; the parts are then kept.
+        static G4bool MergeTextFiles(const G4String& target, const std::vector<G4String>& parts,
+                                   G4bool ntupleHeader, G4bool removeParts);
 
     private:
         G4String outputDirectory;
+        G4Timer fTimer;
+        // Master: /run/initialize to the first run, tables included
+        G4double fInitSeconds;
+        // Master: end of the previous run (or construction) to this run's
+        // start, i.e. the macro commands between them: geometry moves or
+        // /run/reinitializeGeometry, and the run initialisation
+        G4Timer fSetupTimer;
+        G4double fSetupSeconds;
+
+        // Output format: "phx" (binary columnar) or "csv" (G4 ntuples)
+        G4String fOutputFormat;
+        // Also write one raw row per step (debug)
+        G4bool   fWriteSteps;
+        // PHXC rows go through a writer thread (AsyncColumnWriter)
+        G4bool   fAsyncOutput;
+        // Primaries table: "all" events, only those with crystal "hits", or "none"
+        G4String fPrimaryLog;
+        G4GenericMessenger* fMessengerOutput;
+
+        // Voxelised deposit map over the crystals (MyVoxelScorer)
+        G4bool        fVoxelActive;
+        G4ThreeVector fVoxelGrid;
+        G4GenericMessenger* fMessengerVoxel;
+
+        // Stepping profile by (volume, particle, process) (MyStepProfiler)
+        G4bool fProfileActive;
+        G4int  fProfileTop;
+        G4GenericMessenger* fMessengerProfile;
+
+        // Phase-space recording around a volume (MyPhaseSpaceRecorder)
+        G4bool   fPhaseSpaceRecord;
+        G4String fPhaseSpaceVolume;
+        G4GenericMessenger* fMessengerPhaseSpace;
+
+        // Online H1/H2 spectra (MyHistograms); binning as bins, min, max
+        G4bool        fHistActive;
+        G4ThreeVector fHistEdep;
+        G4ThreeVector fHistKinetic;
+        G4ThreeVector fHistDepth;
+        G4GenericMessenger* fMessengerHist;
+
+        // Events between checkpoints, 0 for none (MyCheckpoint)
+        G4int fCheckpointEvery;
+        G4GenericMessenger* fMessengerCheckpoint;
+
+        // <outputDirectory>/output<runID>
+        G4String RunFileBase(const G4Run*) const;
+
+        // Master only: fold the per-thread files into the sequential layout
+        void MergeThreadOutputs(const G4Run*) const;
+
+        // Master only: <base>_PhaseSpace_info.csv (source events, surface)
+        void WritePhaseSpaceInfo(const G4Run*) const;
 };
 
 #endif
@@ -1,19 +1,38 @@
 #ifndef MY_SENSITIVE_DETECTOR_HH
 #define MY_SENSITIVE_DETECTOR_HH
 
+#include <unordered_map>
+
 #include "G4VSensitiveDetector.hh"
 #include "G4AnalysisManager.hh"
 #include "G4RunManager.hh"
 
+#include "MyCrystalHit.hh"
+#include "MyHitWriter.hh"
+#include "MyProcessDictionary.hh"
+
+// Fills the "CrystalHits" collection with one MyCrystalHit per (track,
+// crystal copy); MyEventAction aggregates it at end of event. Raw step
+// rows are only written when /phoenix/output/steps is enabled.
 class MySensitiveDetector : public G4VSensitiveDetector{
 
     public:
         MySensitiveDetector(G4String);
         ~MySensitiveDetector();
 
+        // Called once per event: new hits collection, cached event ID
+        virtual void Initialize(G4HCofThisEvent*);
+
     private:
         virtual G4bool ProcessHits(G4Step *, G4TouchableHistory *);
 
+        G4int fEventID;
+        G4int fHCID;
+        MyCrystalHitsCollection* fHitsCollection;
+
+        // (trackID, copyNo) -> index in fHitsCollection
+        std::unordered_map<G4long, std::size_t> fHitIndex;
+
 };
 
 #endif
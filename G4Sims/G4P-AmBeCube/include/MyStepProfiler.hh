@@ -0,0 +1,96 @@
+#ifndef MY_STEP_PROFILER_HH
+#define MY_STEP_PROFILER_HH
+
+#include <chrono>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+
+class G4LogicalVolume;
+class G4ParticleDefinition;
+class G4Step;
+class G4Track;
+class G4VProcess;
+
+// Opt-in CPU profile of the transport, keyed by (logical volume, particle,
+// process). Per key: the steps taken in the volume and limited by the
+// process, the wall time spent on them, and the tracks born there by that
+// process (the creator; "primary" for primaries). A step's time is the
+// wall time since the previous step of the same track, or since the track
+// started.
+//
+// One instance per thread, keyed by pointer on the hot path; the
+// G4AccumulableManager merges the workers into the master by name at end
+// of run, and the master writes the report.
+class MyStepProfiler : public G4VAccumulable {
+    public:
+        static MyStepProfiler* Instance();
+
+        void SetActive(G4bool value) { fActive = value; }
+        G4bool IsActive() const { return fActive; }
+
+        // From the tracking and stepping actions, only when active
+        void StartTrack(const G4Track* track);
+        void Step(const G4Step* step);
+
+        virtual void Merge(const G4VAccumulable& other);
+        virtual void Reset();
+
+        // Master, end of run: the nTop most expensive keys to G4cout, and
+        // every key to a CSV file
+        void Report(const G4String& csvPath, G4int nTop);
+
+        // Checkpoints of sequential runs: the entries so far, by name.
+        // Loaded entries are added to the report of the run.
+        void Save(std::ostream& out) const;
+        G4bool Load(std::istream& in);
+
+    private:
+        MyStepProfiler();
+
+        using Clock = std::chrono::steady_clock;
+
+        struct Key {
+            const G4LogicalVolume*      volume;
+            const G4ParticleDefinition* particle;
+            const G4VProcess*           process;
+            bool operator==(const Key& o) const {
+                return volume == o.volume && particle == o.particle && process == o.process;
+            }
+        };
+        struct KeyHash {
+            std::size_t operator()(const Key& k) const {
+                std::size_t h = std::hash<const void*>()(k.volume);
+                h = h * 31 + std::hash<const void*>()(k.particle);
+                return h * 31 + std::hash<const void*>()(k.process);
+            }
+        };
+        struct Entry {
+            G4long   nSteps  = 0;
+            G4long   nTracks = 0;
+            G4double seconds = 0.;
+        };
+        using NamedKey = std::tuple<G4String, G4String, G4String>;
+
+        Entry& Find(const Key& key);
+        // Adds this thread's pointer-keyed entries to a table keyed by name
+        void FoldByName(std::map<NamedKey, Entry>& named) const;
+
+        G4bool fActive;
+
+        std::unordered_map<Key, Entry, KeyHash> fEntries;
+        // Consecutive steps mostly share a key
+        Key    fLastKey;
+        Entry* fLastEntry;
+        Clock::time_point fLastTime;
+
+        // Master only: merged worker entries
+        std::map<NamedKey, Entry> fMerged;
+};
+
+#endif
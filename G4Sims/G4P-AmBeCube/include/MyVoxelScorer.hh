@@ -0,0 +1,61 @@
+#ifndef MY_VOXEL_SCORER_HH
+#define MY_VOXEL_SCORER_HH
+
+#include <iosfwd>
+#include <map>
+#include <vector>
+
+#include "G4VAccumulable.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+class G4Step;
+
+// Deposited energy on a regular nx*ny*nz grid over every crystal copy.
+// One instance per thread accumulates the sensitive-detector steps; the
+// G4AccumulableManager merges the worker grids into the master's at end of
+// run, and the master writes them with Write().
+class MyVoxelScorer : public G4VAccumulable {
+    public:
+        static MyVoxelScorer* Instance();
+
+        // Grid used from the next Reset() on
+        void SetGrid(G4int nx, G4int ny, G4int nz);
+        void SetActive(G4bool value) { fActive = value; }
+        G4bool IsActive() const { return fActive; }
+
+        // Bins the step at its midpoint in the crystal's local frame
+        void Score(const G4Step* step, G4int copyNo);
+
+        virtual void Merge(const G4VAccumulable& other);
+        virtual void Reset();
+
+        // PHXC table: one row per voxel of every scored copy
+        void Write(const G4String& path) const;
+
+        // Sums Write() tables of independent jobs (same grid) voxel by
+        // voxel into one; false if none of the parts exists
+        static G4bool MergeFiles(const G4String& target, const std::vector<G4String>& parts);
+
+        // Checkpoint (MyCheckpoint): the grids as raw bytes, so a resumed
+        // run continues from exactly the same sums. Load fails on a grid of
+        // another shape.
+        void Save(std::ostream& out) const;
+        G4bool Load(std::istream& in);
+
+    private:
+        MyVoxelScorer();
+
+        struct Grid {
+            G4ThreeVector halfSize;   // crystal half-lengths
+            G4double      density;    // crystal density
+            std::vector<G4double> edep;
+            std::vector<G4int>    nSteps;
+        };
+
+        G4bool fActive;
+        G4int  fNx, fNy, fNz;
+        std::map<G4int, Grid> fGrids;
+};
+
+#endif
@@ -0,0 +1,87 @@
+// SpectrumLibrary.hh
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SpectrumSampler.hh"
+
+// Sampling tables of a spectrum with N nodes, filled at compile time by
+// MakeSpectrumTable. No heap: a constexpr instance lives in read-only data.
+template <std::size_t N>
+struct SpectrumTable {
+  static_assert(N >= 2, "a spectrum needs at least two nodes");
+  static constexpr int kBins = static_cast<int>(N - 1);
+
+  double E0[kBins] = {}, h[kBins] = {}, w0[kBins] = {}, sum[kBins] = {}, diff2[kBins] = {};
+  double prob[kBins] = {}, invProb[kBins] = {}, invRest[kBins] = {};
+  std::int64_t alias[kBins] = {};
+
+  constexpr SpectrumView view() const {
+    return {kBins, E0, h, w0, sum, diff2, prob, invProb, invRest, alias};
+  }
+};
+
+template <std::size_t N>
+constexpr SpectrumTable<N> MakeSpectrumTable(const double (&E)[N], const double (&w)[N]) {
+  SpectrumTable<N> t{};
+  double p[N-1] = {};
+  int    small[N-1] = {}, large[N-1] = {};
+  SpectrumSamplerDetail::build(E, w, SpectrumTable<N>::kBins, t.E0, t.h, t.w0, t.sum, t.diff2,
+                               t.prob, t.invProb, t.invRest, t.alias, p, small, large);
+  return t;
+}
+
+// Built-in neutron spectra: energies (MeV) and relative pdf at the nodes
+namespace Spectra {
+
+// Values taken from Pavel's sim
+inline constexpr double kAmBeEnergy[] = {
+  0.0, 0.000000414, 0.11, 0.33, 0.54, 0.75, 0.97, 1.18, 1.40, 1.61,
+  1.82, 2.04, 2.25, 2.47, 2.68, 2.90, 3.11, 3.32, 3.54, 3.75,
+  3.97, 4.18, 4.39, 4.61, 4.82, 5.04, 5.25, 5.47, 5.68, 5.89,
+  6.11, 6.32, 6.54, 6.75, 6.96, 7.18, 7.39, 7.61, 7.82, 8.03,
+  8.25, 8.46, 8.68, 8.89, 9.11, 9.32, 9.53, 9.75, 9.96, 10.18,
+  10.39, 10.60, 10.82, 11.03, 11.09
+};
+inline constexpr double kAmBeWeight[] = {
+  0.0, 0.01440, 0.03340, 0.03130, 0.02810, 0.02500, 0.02140, 0.01980, 0.01750, 0.01920,
+  0.02230, 0.02150, 0.02250, 0.02280, 0.02950, 0.03560, 0.03690, 0.03460, 0.03070, 0.03000,
+  0.02690, 0.02860, 0.03180, 0.03070, 0.03330, 0.03040, 0.02740, 0.02330, 0.02060, 0.01820,
+  0.01770, 0.02040, 0.01830, 0.01630, 0.01680, 0.01680, 0.01880, 0.01840, 0.01690, 0.01440,
+  0.00963, 0.00652, 0.00426, 0.00367, 0.00381, 0.00506, 0.00625, 0.00552, 0.00468, 0.00370,
+  0.00278, 0.00151, 0.00036, 0.00000, 0.00000
+};
+inline constexpr auto kAmBe = MakeSpectrumTable(kAmBeEnergy, kAmBeWeight);
+
+// Cf-252 spontaneous fission: ISO 8529-1 Maxwellian sqrt(E) exp(-E/T),
+// T = 1.42 MeV, normalised to a peak of 1
+inline constexpr double kCf252Energy[] = {
+  0.0, 0.01, 0.025, 0.05, 0.1, 0.15, 0.2, 0.3, 0.4, 0.5,
+  0.6, 0.8, 1.0, 1.2, 1.4, 1.6, 1.8, 2.0, 2.25, 2.5,
+  2.75, 3.0, 3.5, 4.0, 4.5, 5.0, 5.5, 6.0, 7.0, 8.0,
+  9.0, 10.0, 11.0, 12.0, 14.0, 16.0, 18.0, 20.0
+};
+inline constexpr double kCf252Weight[] = {
+  0.0, 1.9502e-01, 3.0511e-01, 4.2396e-01, 5.7882e-01, 6.8438e-01, 7.6291e-01, 8.7084e-01, 9.3718e-01, 9.7655e-01,
+  9.9701e-01, 1.0000e+00, 9.7115e-01, 9.2408e-01, 8.6699e-01, 8.0509e-01, 7.4174e-01, 6.7914e-01, 6.0406e-01, 5.3394e-01,
+  4.6960e-01, 4.1131e-01, 3.1240e-01, 2.3485e-01, 1.7517e-01, 1.2984e-01, 9.5760e-02, 7.0333e-02, 3.7565e-02, 1.9858e-02,
+  1.0415e-02, 5.4290e-03, 2.8156e-03, 1.4542e-03, 3.8407e-04, 1.0040e-04, 2.6039e-05, 6.7115e-06
+};
+inline constexpr auto kCf252 = MakeSpectrumTable(kCf252Energy, kCf252Weight);
+
+} // namespace Spectra
+
+// Looks spectra up by name. Built-ins ("AmBe", "Cf252") cost nothing; any
+// other name is a file, loaded once per process and shared by all threads:
+//   *.csv      text, one "E_MeV,weight" pair per line ('#' comments and a
+//              non-numeric header line are skipped)
+//   otherwise  binary, memory-mapped: "PHXS", uint32 version (1),
+//              uint64 n, then n doubles E (MeV) and n doubles w, native endian
+// Throws std::runtime_error when the file cannot be read or is invalid.
+class SpectrumLibrary {
+public:
+  static SpectrumView Get(const std::string& nameOrPath);
+  static std::vector<std::string> BuiltinNames();
+};
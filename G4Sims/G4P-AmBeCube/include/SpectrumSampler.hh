@@ -2,55 +2,222 @@
 #pragma once
 #include <vector>
 #include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <stdexcept>
+#if __cplusplus >= 202002L
+#include <span>
+#endif
 
-class SpectrumSampler {
-public:
-  // Pass in energies (MeV) and weights w ~ pdf(E) at the same points.
-  // E must be strictly increasing; w >= 0.
-  SpectrumSampler(std::vector<double> E, std::vector<double> w)
-  : E_(std::move(E)), w_(std::move(w)) {
-    if (E_.size() < 2 || E_.size() != w_.size())
-      throw std::runtime_error("SpectrumSampler: bad input sizes");
-    for (size_t i=1;i<E_.size();++i)
-      if (!(E_[i] > E_[i-1])) throw std::runtime_error("E must be strictly increasing");
-    buildCDF();
+namespace SpectrumSamplerDetail {
+
+// By value: std::min/max return references, which blocks vectorisation
+inline double clamp01(double x) { return x < 0.0 ? 0.0 : (x > 1.0 ? 1.0 : x); }
+
+// One draw. The body is branch-free: every load is unconditional and the
+// selects are value ternaries, so a loop over it if-converts and vectorises.
+inline double draw(double u, int nBins,
+                   const double* prob, const double* invProb, const double* invRest,
+                   const std::int64_t* alias,
+                   const double* E0, const double* h, const double* w0,
+                   const double* sum, const double* diff2) {
+  // Bin from the alias table; the remainder of u*n is reused in the bin
+  double x = clamp01(u) * nBins;
+  std::int64_t i = static_cast<std::int64_t>(x);
+  i = i < nBins ? i : nBins - 1;
+  double f = x - i;
+
+  double p    = prob[i];
+  bool   keep = f < p;
+  std::int64_t j = keep ? i : alias[i];
+  double v    = keep ? f * invProb[i] : (f - p) * invRest[i];
+  v = clamp01(v);
+
+  // The fraction v of bin j's area lies below E0 + t*h, with
+  // w0*t + (w1-w0)*t^2/2 = v*(w0+w1)/2; the root is taken in the form
+  // that stays accurate for flat bins (w1 == w0) and for w0 == 0
+  double num = v * sum[j];
+  double den = w0[j] + std::sqrt(w0[j]*w0[j] + v * diff2[j]);
+  double t   = num / (den > 1e-300 ? den : 1e-300);  // den == 0 only with num == 0
+  return E0[j] + (t < 1.0 ? t : 1.0) * h[j];
+}
+
+// The batch loop. GCC only honours restrict on the parameters of a function
+// that is not inlined, and without the no-alias guarantee the table gathers
+// keep the loop scalar; hence the out-of-line attribute.
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+inline void kernel(const double* __restrict u, double* __restrict out, size_t n, int nBins,
+                   const double*       __restrict prob,
+                   const double*       __restrict invProb,
+                   const double*       __restrict invRest,
+                   const std::int64_t* __restrict alias,
+                   const double*       __restrict E0,
+                   const double*       __restrict h,
+                   const double*       __restrict w0,
+                   const double*       __restrict sum,
+                   const double*       __restrict diff2) {
+  for (size_t k = 0; k < n; ++k)
+    out[k] = draw(u[k], nBins, prob, invProb, invRest, alias, E0, h, w0, sum, diff2);
+}
+
+// Fills the per-bin tables from nBins+1 nodes (E, w). constexpr so that the
+// built-in spectra (SpectrumLibrary.hh) are tabulated by the compiler; p,
+// small and large are scratch arrays of nBins entries. Bad input throws,
+// which for a built-in is a compile error.
+constexpr void build(const double* E, const double* w, int nBins,
+                     double* E0, double* h, double* w0, double* sum, double* diff2,
+                     double* prob, double* invProb, double* invRest, std::int64_t* alias,
+                     double* p, int* small, int* large) {
+  if (nBins < 1) throw std::runtime_error("SpectrumSampler: bad input sizes");
+  if (!(w[0] >= 0.0)) throw std::runtime_error("SpectrumSampler: negative weight");
+
+  // Trapezoidal integral: area_i = 0.5*(w[i]+w[i+1]) * (E[i+1]-E[i])
+  double total = 0.0;
+  for (int i=0;i<nBins;++i) {
+    if (!(E[i+1] > E[i])) throw std::runtime_error("E must be strictly increasing");
+    if (!(w[i+1] >= 0.0)) throw std::runtime_error("SpectrumSampler: negative weight");
+    E0[i]    = E[i];
+    h[i]     = E[i+1] - E[i];
+    w0[i]    = w[i];
+    sum[i]   = w[i] + w[i+1];
+    diff2[i] = w[i+1]*w[i+1] - w[i]*w[i];
+    p[i]     = 0.5 * sum[i] * h[i];
+    total   += p[i];
+  }
+  if (!(total > 0.0)) throw std::runtime_error("SpectrumSampler: total area <= 0");
+
+  // Vose's alias method on the bin probabilities scaled to a mean of 1
+  int nSmall = 0, nLarge = 0;
+  for (int i=0;i<nBins;++i) {
+    prob[i]  = 1.0;
+    alias[i] = i;
+    p[i] = p[i] / total * nBins;
+    if (p[i] < 1.0) small[nSmall++] = i;
+    else            large[nLarge++] = i;
   }
+  while (nSmall > 0 && nLarge > 0) {
+    int s = small[--nSmall];
+    int l = large[nLarge - 1];
+    prob[s]  = p[s];
+    alias[s] = l;
+    p[l] -= 1.0 - p[s];
+    if (p[l] < 1.0) { --nLarge; small[nSmall++] = l; }
+  }
+  // Whatever is left keeps prob = 1 (it is 1 up to rounding)
+
+  for (int i=0;i<nBins;++i) {
+    invProb[i] = prob[i] > 0.0 ? 1.0 / prob[i] : 0.0;
+    invRest[i] = prob[i] < 1.0 ? 1.0 / (1.0 - prob[i]) : 0.0;
+  }
+}
+
+} // namespace SpectrumSamplerDetail
+
+// Draws energies from a tabulated spectrum: pdf(E) is piecewise linear
+// between the nodes (trapezoidal bins).
+//
+// A single uniform u picks the bin through a Walker/Vose alias table (O(1),
+// no search); the leftover fraction of u is rescaled to a fresh uniform v in
+// that bin, and the bin's CDF, which is quadratic in E, is inverted exactly.
+// There are no data-dependent loops, so the batch overloads vectorise.
+//
+// The view does not own the tables: they belong to a built-in constexpr
+// spectrum or to a SpectrumSampler. It is a handful of pointers, so
+// generators keep one by value at no cost per thread.
+struct SpectrumView {
+  int nBins = 0;
+
+  // Per bin: lower edge, width, pdf at the lower edge, and the two terms of
+  // the in-bin inverse (w0+w1 and w1^2-w0^2)
+  const double *E0 = nullptr, *h = nullptr, *w0 = nullptr, *sum = nullptr, *diff2 = nullptr;
+
+  // Alias table over the bin areas, with 1/prob and 1/(1-prob) to rescale
+  // the remainder of u without a division
+  const double *prob = nullptr, *invProb = nullptr, *invRest = nullptr;
+  const std::int64_t* alias = nullptr;  // 64-bit like the doubles: gathers vectorise
 
   // u in [0,1) -> sample energy (MeV)
   double sample(double u) const {
-    if (u <= 0.0) return E_.front();
-    if (u >= 1.0) return E_.back();
+    return SpectrumSamplerDetail::draw(u, nBins, prob, invProb, invRest, alias,
+                                       E0, h, w0, sum, diff2);
+  }
 
-    // find first cdf[j] >= u
-    auto it = std::lower_bound(C_.begin(), C_.end(), u);
-    size_t j = std::distance(C_.begin(), it);
-    if (j == 0) return E_.front();
+  // The batch API (any standard): out[k] = sample(u[k]) for k < n; u and
+  // out must not overlap
+  void sample(const double* u, double* out, size_t n) const {
+    SpectrumSamplerDetail::kernel(u, out, n, nBins, prob, invProb, invRest, alias,
+                                  E0, h, w0, sum, diff2);
+  }
 
-    // linearly interpolate E between nodes according to CDF spacing
-    double u0 = C_[j-1], u1 = C_[j];
-    double t  = (u - u0) / std::max(1e-16, (u1 - u0)); // [0,1]
-    double E0 = E_[j-1], E1 = E_[j];
-    return E0 + t * (E1 - E0);
+  // Checked wrappers of the same: out must hold at least u.size() values
+  void sample(const std::vector<double>& u, std::vector<double>& out) const {
+    checkBatch(u.size(), out.size());
+    sample(u.data(), out.data(), u.size());
   }
+#if __cplusplus >= 202002L
+  void sample(std::span<const double> u, std::span<double> out) const {
+    checkBatch(u.size(), out.size());
+    sample(u.data(), out.data(), u.size());
+  }
+#endif
+
+  double minEnergy() const { return E0[0]; }
+  double maxEnergy() const { return E0[nBins-1] + h[nBins-1]; }
 
 private:
-  std::vector<double> E_, w_, C_;
+  static void checkBatch(size_t nIn, size_t nOut) {
+    if (nOut < nIn) throw std::runtime_error("SpectrumSampler: output smaller than input");
+  }
+};
+
+// Owns the tables of a spectrum only known at run time (e.g. read from a file)
+class SpectrumSampler {
+public:
+  // Pass in energies (MeV) and weights w ~ pdf(E) at the same points.
+  // E must be strictly increasing; w >= 0.
+  SpectrumSampler(const std::vector<double>& E, const std::vector<double>& w)
+  : SpectrumSampler(E.data(), w.data(), E.size() == w.size() ? E.size() : 0) {}
 
-  void buildCDF() {
-    const size_t n = E_.size();
-    C_.assign(n, 0.0);
+  // Same from n nodes in place, e.g. in a memory-mapped file
+  SpectrumSampler(const double* E, const double* w, size_t n) {
+    if (n < 2) throw std::runtime_error("SpectrumSampler: bad input sizes");
+    const int nBins = static_cast<int>(n - 1);
+    for (auto* v : {&E0_, &h_, &w0_, &sum_, &diff2_, &prob_, &invProb_, &invRest_})
+      v->resize(nBins);
+    alias_.resize(nBins);
 
-    // Trapezoidal integral: area_i = 0.5*(w[i-1]+w[i]) * (E[i]-E[i-1])
-    for (size_t i=1;i<n;++i) {
-      double dE = E_[i] - E_[i-1];
-      double area = 0.5 * (w_[i-1] + w_[i]) * dE;
-      C_[i] = C_[i-1] + std::max(0.0, area);
-    }
-    double total = C_.back();
-    if (total <= 0.0) throw std::runtime_error("SpectrumSampler: total area <= 0");
+    std::vector<double> p(nBins);
+    std::vector<int>    small(nBins), large(nBins);
+    SpectrumSamplerDetail::build(E, w, nBins, E0_.data(), h_.data(), w0_.data(), sum_.data(),
+                                 diff2_.data(), prob_.data(), invProb_.data(), invRest_.data(),
+                                 alias_.data(), p.data(), small.data(), large.data());
 
-    // Normalize to [0,1]
-    for (auto &c : C_) c /= total;
+    view_ = {nBins, E0_.data(), h_.data(), w0_.data(), sum_.data(), diff2_.data(),
+             prob_.data(), invProb_.data(), invRest_.data(), alias_.data()};
   }
+
+  // view() points into this object, so it is neither copied nor moved
+  SpectrumSampler(const SpectrumSampler&) = delete;
+  SpectrumSampler& operator=(const SpectrumSampler&) = delete;
+
+  const SpectrumView& view() const { return view_; }
+
+  double sample(double u) const { return view_.sample(u); }
+  void   sample(const double* u, double* out, size_t n) const { view_.sample(u, out, n); }
+  void   sample(const std::vector<double>& u, std::vector<double>& out) const { view_.sample(u, out); }
+#if __cplusplus >= 202002L
+  void   sample(std::span<const double> u, std::span<double> out) const { view_.sample(u, out); }
+#endif
+
+  double minEnergy() const { return view_.minEnergy(); }
+  double maxEnergy() const { return view_.maxEnergy(); }
+
+private:
+  std::vector<double> E0_, h_, w0_, sum_, diff2_;
+  std::vector<double> prob_, invProb_, invRest_;
+  std::vector<std::int64_t> alias_;
+  SpectrumView view_;
 };
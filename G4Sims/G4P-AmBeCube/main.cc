@@ -6,9 +6,13 @@
 // Brief    : Shielded AmBe simulation in SOREQ
 // =========================================================================
 
+#include <algorithm>
 #include <iostream>
+#include <cstdlib>
+#include <vector>
 
 #include "G4RunManager.hh"
+#include "G4RunManagerFactory.hh"
 #include "G4UIExecutive.hh"
 #include "G4UImanager.hh"
 #include "G4VisExecutive.hh"
@@ -17,15 +21,97 @@
 #include "MyDetectorConstruction.hh"
 #include "MyPhysicsList.hh"
 #include "MyActionInitialization.hh"
+#include "MyCheckpoint.hh"
+#include "MyJobLauncher.hh"
+#include "MyJobRunManager.hh"
+#include "MyPhysicsCache.hh"
+#include "MyResumeRunManager.hh"
 
+// Usage: AmBeCube-EXE [macro] [outputDir] [-m serial|mt|tasking] [-t nThreads] [-c cacheDir] [--resume]
+//                     [-j nJobs]
 int main(int argc, char **argv) {
 
-    G4RunManager* runManager = new G4RunManager();
-    
+    // Split options from the positional (macro, output directory) arguments
+    G4RunManagerType runType  = G4RunManagerType::Serial;
+    G4int            nThreads = 0;
+    G4int            nJobs    = 1;
+    G4bool           resume   = false;
+    std::vector<G4String> args;
+    for (G4int i = 1; i < argc; ++i) {
+        G4String arg = argv[i];
+        if ((arg == "-m" || arg == "--mode") && i + 1 < argc) {
+            G4String mode = argv[++i];
+            if      (mode == "serial")  runType = G4RunManagerType::Serial;
+            else if (mode == "mt")      runType = G4RunManagerType::MT;
+            else if (mode == "tasking") runType = G4RunManagerType::Tasking;
+            else {
+                G4cerr << "Unknown run mode '" << mode << "' (serial|mt|tasking)" << G4endl;
+                return 1;
+            }
+        }
+        else if ((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+            nThreads = std::atoi(argv[++i]);
+            // Asking for threads without a mode implies the task-based manager
+            if (runType == G4RunManagerType::Serial) runType = G4RunManagerType::Tasking;
+        }
+        else if ((arg == "-c" || arg == "--cache") && i + 1 < argc) {
+            // Warm start: reuse physics tables stored by an earlier invocation
+            MyPhysicsCache::Instance()->SetDirectory(argv[++i]);
+        }
+        else if ((arg == "-j" || arg == "--jobs") && i + 1 < argc) {
+            nJobs = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--resume") {
+            // Continue from <outputDir>/checkpoint after a crash (same macro)
+            resume = true;
+        }
+        else {
+            args.push_back(arg);
+        }
+    }
+
+    // The event order, and so the engine state per event, is only
+    // reproducible in sequential mode
+    if (resume && runType != G4RunManagerType::Serial && nJobs == 1) {
+        G4cerr << "--resume needs sequential mode; drop -m and -t" << G4endl;
+        return 1;
+    }
+    MyCheckpoint::Instance()->SetResume(resume);
+
     // Get output directory from command line if provided
     G4String outputDir = "./";
-    if (argc > 2) {
-        outputDir = argv[2];
+    if (args.size() > 1) {
+        outputDir = args[1];
+    }
+
+    // Independent sequential processes, for builds without multithreading;
+    // the parent only waits and merges
+    G4int job = -1;
+    if (nJobs > 1) {
+        if (args.empty()) {
+            G4cerr << "--jobs needs a macro" << G4endl;
+            return 1;
+        }
+        if (runType != G4RunManagerType::Serial) {
+            G4cout << "--jobs runs every job sequentially; -m and -t are ignored" << G4endl;
+        }
+        job = MyJobLauncher::Fork(outputDir, nJobs);
+        if (job < 0) {
+            if (!MyJobLauncher::Wait()) return 1;
+            return MyJobLauncher::Merge(outputDir, nJobs) ? 0 : 1;
+        }
+        outputDir = MyJobLauncher::JobDirectory(outputDir, job);
+    }
+    MyCheckpoint::Instance()->SetDirectory(outputDir + "/checkpoint");
+
+    G4RunManager* runManager = nullptr;
+    if (job >= 0) {
+        runManager = new MyJobRunManager(job, nJobs);
+    } else if (resume) {
+        runManager = new MyResumeRunManager();
+    } else {
+        runManager = G4RunManagerFactory::CreateRunManager(runType);
+        if (nThreads > 0) runManager->SetNumberOfThreads(nThreads);
     }
 
     runManager->SetUserInitialization(new MyDetectorConstruction(outputDir));
@@ -37,7 +123,7 @@ int main(int argc, char **argv) {
 
     // Initialize visualisation only if no macro is passed
     G4UIExecutive* ui = 0;
-    if(argc==1){
+    if(args.empty()){
        ui = new G4UIExecutive(argc, argv);
     }
 
@@ -51,13 +137,19 @@ int main(int argc, char **argv) {
 
     if(ui){
         uiManager->ApplyCommand("/control/execute vis.mac");
-        ui->SessionStart();    
+        ui->SessionStart();
+        delete ui;
     }
     else{
         G4String command = "/control/execute ";
-        G4String filename = argv[1];
+        G4String filename = args[0];
         uiManager->ApplyCommand(command + filename);
     }
- 
+
+    // Deleting the run manager ends the worker threads, which closes and
+    // removes their per-thread output files
+    delete visManager;
+    delete runManager;
+
     return 0;
-}; 
+};
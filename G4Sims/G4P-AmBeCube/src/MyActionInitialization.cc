@@ -1,4 +1,8 @@
 #include "MyActionInitialization.hh"
+#include "MyEventAction.hh"
+#include "MyStackingAction.hh"
+#include "MySteppingAction.hh"
+#include "MyTrackingAction.hh"
 
 MyActionInitialization::MyActionInitialization(const G4String& outputPath) : fOutputPath(outputPath) {
 }
@@ -6,12 +10,23 @@ MyActionInitialization::MyActionInitialization(const G4String& outputPath) : fOu
 MyActionInitialization::~MyActionInitialization() {
 }
 
+void MyActionInitialization::BuildForMaster() const {
+    // Master only merges the per-thread outputs at end of run
+    MyRunAction *runAction = new MyRunAction();
+    runAction->SetOutputDirectory(fOutputPath);
+    SetUserAction(runAction);
+};
+
 void MyActionInitialization::Build() const {
-    MyPrimaryGenerator *generator = new MyPrimaryGenerator(fOutputPath);
-    SetUserAction(generator);
+    SetUserAction(new MyPrimaryGenerator());
 
     MyRunAction *runAction = new MyRunAction();
     runAction->SetOutputDirectory(fOutputPath);
     SetUserAction(runAction);
 
+    SetUserAction(new MyEventAction());
+    SetUserAction(new MyStackingAction());
+    SetUserAction(new MyTrackingAction());
+    SetUserAction(new MySteppingAction());
+
 };
@@ -0,0 +1,295 @@
+#include "MyCheckpoint.hh"
+#include "MyHistograms.hh"
+#include "MyHitWriter.hh"
+#include "MyPhaseSpaceSource.hh"
+#include "MyPrimaryGenerator.hh"
+#include "MyRunSummary.hh"
+#include "MyStepProfiler.hh"
+#include "MyVoxelScorer.hh"
+
+#include "G4Event.hh"
+#include "G4Exception.hh"
+#include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "Randomize.hh"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// The replayed PhaseSpace table of the sequential run, if any
+static MyPhaseSpaceSource* replayedPhaseSpace() {
+    const auto *generator = dynamic_cast<const MyPrimaryGenerator*>(
+        G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction());
+    return generator ? generator->GetPhaseSpace() : nullptr;
+}
+
+MyCheckpoint* MyCheckpoint::Instance() {
+    static MyCheckpoint* instance = nullptr;
+    if (!instance) instance = new MyCheckpoint();
+    return instance;
+}
+
+MyCheckpoint::MyCheckpoint()
+    : fDirectory("./checkpoint"), fResume(false), fInterval(0),
+      fActive(false), fPrepared(false), fRestore(false), fRunID(-1), fTotal(0), fEventBase(0), fFirstEvent(0),
+      fSecondsBefore(0.) {
+}
+
+G4int MyCheckpoint::BeginOfBeamOn(G4int runID, G4int nEvents, G4int eventBase, G4bool usable) {
+
+    fPrepared   = true;
+    fRestore    = false;
+    fRunID      = runID;
+    fTotal      = nEvents;
+    fEventBase  = eventBase;
+    fFirstEvent = 0;
+    if (!fResume) return 0;
+
+    if (!usable) {
+        // Starting over would overwrite the files the checkpoint describes
+        G4Exception("MyCheckpoint::BeginOfBeamOn", "MyCheckpoint001", FatalErrorInArgument,
+                    "--resume needs /phoenix/output/format phx");
+        return 0;
+    }
+
+    if (fSaved.run < 0 && !Read(fSaved)) {
+        G4cout << "[MyCheckpoint] No checkpoint in '" << fDirectory << "': starting from scratch" << G4endl;
+        fResume = false;
+        return 0;
+    }
+
+    if (runID < fSaved.run || (runID == fSaved.run && fSaved.nextEvent >= fSaved.total)) {
+        G4cout << "[MyCheckpoint] Run " << runID << " was completed before the restart: skipped" << G4endl;
+        // The engine as it was when this run ended, for the commands and
+        // runs that follow in the macro
+        if (runID == fSaved.run) {
+            RestoreEngine(fSaved);
+            fResume = false;
+        }
+        fPrepared = false;
+        return -1;
+    }
+
+    fResume = false;
+    if (runID > fSaved.run) return 0;
+
+    if (fSaved.total != nEvents) {
+        G4cerr << "[MyCheckpoint] Checkpoint of run " << runID << " is for " << fSaved.total
+               << " events, this run has " << nEvents << ": starting the run over" << G4endl;
+        return 0;
+    }
+    if (!RestoreEngine(fSaved)) return 0;
+
+    fRestore    = true;
+    fFirstEvent = fSaved.nextEvent;
+    G4cout << "[MyCheckpoint] Resuming run " << runID << " at event " << fFirstEvent
+           << " of " << nEvents << G4endl;
+    return fFirstEvent;
+}
+
+void MyCheckpoint::BeginOfRun(const G4Run* run, G4bool usable) {
+
+    // Without the resume run manager every run starts at its first event
+    if (!fPrepared || run->GetRunID() != fRunID) {
+        fRunID      = run->GetRunID();
+        fTotal      = run->GetNumberOfEventToBeProcessed();
+        fEventBase  = 0;
+        fFirstEvent = 0;
+        fRestore    = false;
+    }
+    fPrepared = false;
+    fOffsets.clear();
+    fSecondsBefore = 0.;
+    fActive   = usable && fInterval > 0;
+
+    if (!usable && fInterval > 0) {
+        G4cerr << "[MyCheckpoint] Checkpoints need sequential mode and phx output: none are taken" << G4endl;
+    }
+    if (!fRestore) return;
+    fRestore = false;
+
+    if (fSaved.voxels) {
+        std::ifstream in(fSaved.dir + "/voxels.bin", std::ios::binary);
+        if (!MyVoxelScorer::Instance()->Load(in)) {
+            G4cerr << "[MyCheckpoint] Voxel grids in '" << fSaved.dir
+                   << "' do not match /phoenix/voxel/grid: the map restarts empty" << G4endl;
+        }
+    }
+    MyHistograms *histograms = MyHistograms::Instance();
+    if (histograms->IsActive() && !(fSaved.histograms && histograms->Load(fSaved.dir))) {
+        G4cerr << "[MyCheckpoint] No histograms in '" << fSaved.dir
+               << "' with the /phoenix/hist binning: they restart empty" << G4endl;
+    }
+    std::ifstream summary(fSaved.dir + "/summary.bin", std::ios::binary);
+    if (!MyRunSummary::Instance()->Load(summary, fSaved.seconds)) {
+        G4cerr << "[MyCheckpoint] No run summary in '" << fSaved.dir
+               << "': it only covers the events after the restart" << G4endl;
+    }
+    MyStepProfiler *profiler = MyStepProfiler::Instance();
+    if (profiler->IsActive()) {
+        std::ifstream profile(fSaved.dir + "/profile.csv");
+        if (!(fSaved.profile && profiler->Load(profile))) {
+            G4cerr << "[MyCheckpoint] No step profile in '" << fSaved.dir
+                   << "': it only covers the events after the restart" << G4endl;
+        }
+    }
+    fOffsets       = fSaved.offsets;
+    fSecondsBefore = fSaved.seconds;
+}
+
+void MyCheckpoint::Start() {
+    fStartTime = std::chrono::steady_clock::now();
+    if (fActive) Save(fFirstEvent);
+}
+
+void MyCheckpoint::EndOfEvent(const G4Event* event) {
+
+    if (!fActive) return;
+
+    G4int next = event->GetEventID() - fEventBase + 1;
+    if (next >= fTotal || next % fInterval != 0) return;
+    Save(next);
+}
+
+void MyCheckpoint::EndOfRun() {
+    if (fActive) Save(fTotal);
+    fFirstEvent = 0;
+}
+
+void MyCheckpoint::Save(G4int nextEvent) {
+
+    const fs::path dir(fDirectory);
+    const fs::path tmp(fDirectory + ".tmp");
+    const fs::path old(fDirectory + ".old");
+
+    std::error_code ec;
+    fs::remove_all(tmp, ec);
+    fs::create_directories(tmp, ec);
+
+    // Everything before nextEvent is on disk once this returns
+    std::vector<std::uint64_t> offsets = MyHitWriter::Instance()->Flush();
+
+    G4Random::saveEngineStatus((tmp / "rng.state").string().c_str());
+
+    MyVoxelScorer *voxels = MyVoxelScorer::Instance();
+    if (voxels->IsActive()) {
+        std::ofstream out(tmp / "voxels.bin", std::ios::binary);
+        voxels->Save(out);
+    }
+
+    MyHistograms *histograms = MyHistograms::Instance();
+    if (histograms->IsActive()) histograms->Save(tmp.string());
+
+    {
+        std::ofstream out(tmp / "summary.bin", std::ios::binary);
+        MyRunSummary::Instance()->Save(out);
+    }
+    MyStepProfiler *profiler = MyStepProfiler::Instance();
+    if (profiler->IsActive()) {
+        std::ofstream out(tmp / "profile.csv");
+        profiler->Save(out);
+    }
+
+    G4double seconds = fSecondsBefore +
+        std::chrono::duration<G4double>(std::chrono::steady_clock::now() - fStartTime).count();
+
+    std::ofstream csv(tmp / "checkpoint.csv");
+    csv.precision(17);
+    csv << "key,value\n"
+        << "run," << fRunID << "\n"
+        << "nextEvent," << nextEvent << "\n"
+        << "totalEvents," << fTotal << "\n"
+        << "voxels," << (voxels->IsActive() ? 1 : 0) << "\n"
+        << "histograms," << (histograms->IsActive() ? 1 : 0) << "\n"
+        << "profile," << (profiler->IsActive() ? 1 : 0) << "\n"
+        << "seconds," << seconds << "\n";
+    if (const MyPhaseSpaceSource *phaseSpace = replayedPhaseSpace()) {
+        std::uint64_t next;
+        std::size_t   group;
+        G4int         uses;
+        phaseSpace->GetCursor(next, group, uses);
+        csv << "phaseSpace," << phaseSpace->GetPath() << "\n"
+            << "phaseSpaceNext," << next << "\n"
+            << "phaseSpaceGroup," << group << "\n"
+            << "phaseSpaceUses," << uses << "\n";
+    }
+    for (G4int table = 0; table < MyHitWriter::kNTables; ++table)
+        csv << "offset_" << MyHitWriter::TableName(table) << "," << offsets[table] << "\n";
+    csv.close();
+    if (!csv) {
+        G4cerr << "[MyCheckpoint] Could not write '" << tmp.string() << "'; keeping the previous checkpoint" << G4endl;
+        return;
+    }
+
+    // Swap in the new directory; Read() falls back to .old in between
+    fs::remove_all(old, ec);
+    if (fs::exists(dir)) fs::rename(dir, old, ec);
+    fs::rename(tmp, dir, ec);
+    if (ec) {
+        G4cerr << "[MyCheckpoint] Could not replace '" << fDirectory << "': " << ec.message() << G4endl;
+        return;
+    }
+    fs::remove_all(old, ec);
+}
+
+G4bool MyCheckpoint::Read(Saved& saved) const {
+
+    saved.dir = fDirectory;
+    if (!fs::exists(saved.dir + "/checkpoint.csv")) saved.dir = fDirectory + ".old";
+
+    std::ifstream in(saved.dir + "/checkpoint.csv");
+    if (!in.is_open()) return false;
+
+    saved.offsets.assign(MyHitWriter::kNTables, 0);
+    std::string line;
+    std::getline(in, line);  // header
+    while (std::getline(in, line)) {
+        std::size_t comma = line.find(',');
+        if (comma == std::string::npos) continue;
+        std::string key   = line.substr(0, comma);
+        std::string value = line.substr(comma + 1);
+
+        if      (key == "run")         saved.run       = std::stoi(value);
+        else if (key == "nextEvent")   saved.nextEvent = std::stoi(value);
+        else if (key == "totalEvents") saved.total     = std::stoi(value);
+        else if (key == "voxels")      saved.voxels    = (value == "1");
+        else if (key == "histograms")  saved.histograms = (value == "1");
+        else if (key == "profile")     saved.profile   = (value == "1");
+        else if (key == "seconds")     saved.seconds   = std::stod(value);
+        else if (key == "phaseSpace")      saved.phaseSpace      = value;
+        else if (key == "phaseSpaceNext")  saved.phaseSpaceNext  = std::stoull(value);
+        else if (key == "phaseSpaceGroup") saved.phaseSpaceGroup = std::stoull(value);
+        else if (key == "phaseSpaceUses")  saved.phaseSpaceUses  = std::stoi(value);
+        else {
+            for (G4int table = 0; table < MyHitWriter::kNTables; ++table) {
+                if (key == G4String("offset_") + MyHitWriter::TableName(table))
+                    saved.offsets[table] = std::stoull(value);
+            }
+        }
+    }
+    return saved.run >= 0;
+}
+
+G4bool MyCheckpoint::RestoreEngine(const Saved& saved) const {
+
+    G4String path = saved.dir + "/rng.state";
+    if (!fs::exists(path)) {
+        G4cerr << "[MyCheckpoint] No engine status '" << path << "': the run is not reproducible" << G4endl;
+        return false;
+    }
+    MyPhaseSpaceSource *phaseSpace = replayedPhaseSpace();
+    G4String replayed = phaseSpace ? phaseSpace->GetPath() : G4String("");
+    if (replayed != saved.phaseSpace) {
+        G4cerr << "[MyCheckpoint] The checkpoint replays '" << saved.phaseSpace << "', this run '"
+               << replayed << "': the state is not restored" << G4endl;
+        return false;
+    }
+
+    G4Random::restoreEngineStatus(path.c_str());
+    // The replay continues with the source events after the saved ones
+    if (phaseSpace) phaseSpace->SetCursor(saved.phaseSpaceNext, saved.phaseSpaceGroup, saved.phaseSpaceUses);
+    return true;
+}
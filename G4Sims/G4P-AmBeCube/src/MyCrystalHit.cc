@@ -0,0 +1,12 @@
+#include "MyCrystalHit.hh"
+
+G4ThreadLocal G4Allocator<MyCrystalHit>* MyCrystalHitAllocator = nullptr;
+
+MyCrystalHit::MyCrystalHit(G4int trackID, G4int parentID, G4int pdg, G4int copyNo,
+                           G4int creator, G4bool entered, G4double kinetic, G4double weight)
+    : fTrackID(trackID), fParentID(parentID), fPDG(pdg), fCopyNo(copyNo),
+      fCreator(creator), fEntered(entered), fKinetic(kinetic), fEdep(0.), fNSteps(0), fWeight(weight) {
+}
+
+MyCrystalHit::~MyCrystalHit() {
+}
@@ -1,19 +1,64 @@
 #include "MyDetectorConstruction.hh"
+#include "G4GeometryManager.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4RunManager.hh"
+#include "G4UIcommand.hh"
+#include "G4UnitsTable.hh"
+#include <chrono>
 #include <fstream>
+#include <sstream>
 #include <string>
 
 map<G4String, G4double> MyDetectorConstruction::m_hGeoParams;
-
-MyDetectorConstruction::MyDetectorConstruction(const G4String& outputPath) : fOutputDirectory(outputPath) {
+map<G4VPhysicalVolume*, G4ThreeVector> MyDetectorConstruction::m_hMoved;
+
+MyDetectorConstruction::MyDetectorConstruction(const G4String& outputPath)
+    : fOutputDirectory(outputPath), fCrystalDistance(-1.), fBlockGap(-1.), fOverlapPoints(1000), phys_Lab(nullptr),
+      phys_PLYBlock0(nullptr), phys_PLYBlock1(nullptr),
+      phys_Crystal0(nullptr), phys_Crystal1(nullptr), phys_Crystal2(nullptr), phys_Crystal3(nullptr) {
+
+    // Master only: the workers share the placements
+    fMessengerCube = new G4GenericMessenger(this, "/phoenix/geometry/", "Move volumes between runs");
+
+    fMessengerCube->DeclareMethodWithUnit("crystalDistance", "cm", &MyDetectorConstruction::SetCrystalDistance,
+                                          "Distance of the four crystals from the source axis")
+        .SetParameterName("distance", false)
+        .SetRange("distance > 0.")
+        .SetStates(G4State_PreInit, G4State_Idle)
+        .SetToBeBroadcasted(false);
+
+    fMessengerCube->DeclareMethodWithUnit("blockGap", "cm", &MyDetectorConstruction::SetBlockGap,
+                                          "Gap between the source shield and the PLY blocks")
+        .SetParameterName("gap", false)
+        .SetRange("gap >= 0.")
+        .SetStates(G4State_PreInit, G4State_Idle)
+        .SetToBeBroadcasted(false);
+
+    fMessengerCube->DeclareMethod("move", &MyDetectorConstruction::MoveVolume,
+                                  "Place a volume of the lab at a new position: <phys name> x y z unit")
+        .SetStates(G4State_Idle)
+        .SetToBeBroadcasted(false);
+
+    fMessengerCube->DeclareProperty("checkPoints", fOverlapPoints,
+                                    "Surface points per moved volume for the overlap check (0: no check)")
+        .SetStates(G4State_PreInit, G4State_Idle)
+        .SetToBeBroadcasted(false);
 };
 
 MyDetectorConstruction::~MyDetectorConstruction() {
+    delete fMessengerCube;
 };
 
 
 G4VPhysicalVolume *MyDetectorConstruction::Construct() {
 
     DefineGeoParams();
+    if (fCrystalDistance > 0.) m_hGeoParams["CrystalSource_Distance"] = fCrystalDistance;
+    if (fBlockGap >= 0.)       m_hGeoParams["PLYBlock_Gap"]           = fBlockGap;
+    // New volumes: nothing of them has been moved
+    m_hMoved.clear();
     DefineMaterials();
     ConstructLab();
     ConstructFrame();
@@ -31,6 +76,8 @@ G4VPhysicalVolume *MyDetectorConstruction::Construct() {
     ConstructSourceShield();
     ConstructCrystals();
 
+    DefineRegions();
+
     return phys_Lab;
 }
 
@@ -66,6 +113,7 @@ void MyDetectorConstruction::DefineGeoParams() {
     m_hGeoParams["PLYBlock_Width"]  =  5. *cm;
     m_hGeoParams["PLYBlock_Length"] = 20. *cm;
     m_hGeoParams["PLYBlock_Height"] = 10. *cm;
+    m_hGeoParams["PLYBlock_Gap"]    =  0.1 *cm;  // to the source shield
 
     // ======= Source Shield ======= //
     m_hGeoParams["SourceShield_oRadius"] = 3.35 *cm;
@@ -589,7 +637,7 @@ void MyDetectorConstruction::ConstructPLYBlocks(){
                           + PLYWheel_Height 
                           + PLYBlock_Height/2;
 
-    G4double d_ShieldBlock = 0.1*cm;
+    G4double d_ShieldBlock = m_hGeoParams["PLYBlock_Gap"];
 
     // Place Block 0
     G4double x_PLYBlock0 = SourceShield_oRadius + PLYBlock_Width/2 + d_ShieldBlock;
@@ -731,9 +779,147 @@ void MyDetectorConstruction::ConstructCrystals() {
 }
 
 
+void MyDetectorConstruction::SetCrystalDistance(G4double distance) {
+
+    if (!phys_Crystal0) {
+        fCrystalDistance = distance;
+        G4cout << "[MyDetectorConstruction] Crystals will be built at " << G4BestUnit(distance, "Length")
+               << "from the source axis" << G4endl;
+        return;
+    }
+
+    // Same height as before, at +-d on x and y as in ConstructCrystals
+    G4double z_Crystal = phys_Crystal0->GetTranslation().z();
+    G4bool moved = Move({{phys_Crystal0, G4ThreeVector( distance, 0., z_Crystal)},
+                         {phys_Crystal1, G4ThreeVector(-distance, 0., z_Crystal)},
+                         {phys_Crystal2, G4ThreeVector(0.,  distance, z_Crystal)},
+                         {phys_Crystal3, G4ThreeVector(0., -distance, z_Crystal)}});
+    if (!moved) return;
+
+    fCrystalDistance = distance;
+    m_hGeoParams["CrystalSource_Distance"] = distance;
+    SaveGeoParamsToCSV();
+    G4cout << "[MyDetectorConstruction] Crystals at " << G4BestUnit(distance, "Length") << "from the source axis" << G4endl;
+}
+
+void MyDetectorConstruction::SetBlockGap(G4double gap) {
+
+    if (!phys_Lab) {
+        fBlockGap = gap;
+        G4cout << "[MyDetectorConstruction] PLY blocks will be built " << G4BestUnit(gap, "Length")
+               << "from the source shield" << G4endl;
+        return;
+    }
+    if (!phys_PLYBlock0) {
+        G4cerr << "[MyDetectorConstruction] No PLY blocks placed: nothing to move" << G4endl;
+        return;
+    }
+
+    G4double x_PLYBlock = m_hGeoParams["SourceShield_oRadius"] + m_hGeoParams["PLYBlock_Width"]/2 + gap;
+    G4ThreeVector pos0 = phys_PLYBlock0->GetTranslation();
+    G4ThreeVector pos1 = phys_PLYBlock1->GetTranslation();
+    G4bool moved = Move({{phys_PLYBlock0, G4ThreeVector( x_PLYBlock, pos0.y(), pos0.z())},
+                         {phys_PLYBlock1, G4ThreeVector(-x_PLYBlock, pos1.y(), pos1.z())}});
+    if (!moved) return;
+
+    fBlockGap = gap;
+    m_hGeoParams["PLYBlock_Gap"] = gap;
+    SaveGeoParamsToCSV();
+    G4cout << "[MyDetectorConstruction] PLY blocks " << G4BestUnit(gap, "Length") << "from the source shield" << G4endl;
+}
+
+void MyDetectorConstruction::MoveVolume(G4String args) {
+
+    std::istringstream in(args);
+    G4String name, unit;
+    G4double x, y, z;
+    if (!(in >> name >> x >> y >> z >> unit) || !G4UnitDefinition::IsUnitDefined(unit)) {
+        G4cerr << "[MyDetectorConstruction] Expected '<phys name> x y z unit', got '" << args << "'" << G4endl;
+        return;
+    }
+
+    G4VPhysicalVolume *pv = G4PhysicalVolumeStore::GetInstance()->GetVolume(name, false);
+    if (!pv || !phys_Lab || pv->GetMotherLogical() != phys_Lab->GetLogicalVolume()) {
+        G4cerr << "[MyDetectorConstruction] '" << name << "' is not a volume placed in the lab" << G4endl;
+        return;
+    }
+
+    G4ThreeVector pos = G4ThreeVector(x, y, z) * G4UIcommand::ValueOf(unit.c_str());
+    if (!Move({{pv, pos}})) return;
+
+    G4cout << "[MyDetectorConstruction] " << name << " at " << G4BestUnit(pos, "Length") << G4endl;
+}
+
+G4bool MyDetectorConstruction::Move(const vector<std::pair<G4VPhysicalVolume*, G4ThreeVector>>& moves) {
+
+    if (!phys_Lab || moves.empty()) return false;
+
+    auto start = std::chrono::steady_clock::now();
+    G4GeometryManager *geoManager = G4GeometryManager::GetInstance();
+    G4bool wasClosed = geoManager->IsGeometryClosed();
+
+    // Opening at a daughter drops the optimisation of its mother (the lab)
+    // only; the rest of the tree keeps its voxels
+    G4VPhysicalVolume *pivot = moves.front().first;
+    if (wasClosed) geoManager->OpenGeometry(pivot);
+
+    vector<G4ThreeVector> previous;
+    for (const auto &move : moves) {
+        previous.push_back(move.first->GetTranslation());
+        move.first->SetTranslation(move.second);
+    }
+
+    // The moved volumes against the lab and everything else in it
+    G4bool overlaps = false;
+    if (fOverlapPoints > 0) {
+        for (const auto &move : moves) overlaps |= move.first->CheckOverlaps(fOverlapPoints, 0., true, 1);
+    }
+    if (overlaps) {
+        for (std::size_t i = 0; i < moves.size(); ++i) moves[i].first->SetTranslation(previous[i]);
+        G4cerr << "[MyDetectorConstruction] Move would overlap: volumes left where they were" << G4endl;
+    } else {
+        for (const auto &move : moves) m_hMoved[move.first] = move.second;
+    }
+
+    if (wasClosed) {
+        geoManager->CloseGeometry(true, false, pivot);
+        // Next beamOn resets the master's navigator; the workers pick the
+        // placements up in ApplyMoves. Cuts and physics tables stay.
+        G4RunManager::GetRunManager()->GeometryDirectlyUpdated();
+    }
+
+    G4double ms = std::chrono::duration<G4double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    G4cout << "[MyDetectorConstruction] Moved " << moves.size() << " volume(s) in " << ms
+           << " ms (overlap check and lab voxels included)" << G4endl;
+    return !overlaps;
+}
+
+void MyDetectorConstruction::ApplyMoves() {
+
+    // The master only writes m_hMoved between runs, while the workers wait
+    for (const auto &kv : m_hMoved) {
+        if (kv.first->GetTranslation() != kv.second) kv.first->SetTranslation(kv.second);
+    }
+}
+
+void MyDetectorConstruction::DefineRegions() {
+
+    G4RegionStore *store = G4RegionStore::GetInstance();
+
+    store->FindOrCreateRegion("Crystals")    ->AddRootLogicalVolume(logic_Crystal);
+    store->FindOrCreateRegion("SourceShield")->AddRootLogicalVolume(logic_SourceShield);
+
+    G4Region *structure = store->FindOrCreateRegion("Structure");
+    structure->AddRootLogicalVolume(logic_Floor);
+    structure->AddRootLogicalVolume(logic_Frame);
+}
+
+
 void MyDetectorConstruction::ConstructSDandField(){
 
+    // Registered so that Initialize() creates the hits collection each event
     MySensitiveDetector *sensDet = new MySensitiveDetector("SensitiveDetector");
+    G4SDManager::GetSDMpointer()->AddNewDetector(sensDet);
     logic_Crystal->SetSensitiveDetector(sensDet);
 
 }
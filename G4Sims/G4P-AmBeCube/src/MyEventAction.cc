@@ -1,9 +1,18 @@
 #include "MyEventAction.hh"
+#include "MyCheckpoint.hh"
+#include "MyCrystalHit.hh"
+#include "MyHistograms.hh"
+#include "MyHitWriter.hh"
+#include "MyRunSummary.hh"
 
 #include "G4Event.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4SDManager.hh"
 #include "G4SystemOfUnits.hh"
 
-MyEventAction::MyEventAction() {
+#include <algorithm>
+
+MyEventAction::MyEventAction() : fHCID(-1) {
 };
 
 MyEventAction::~MyEventAction() {
@@ -13,5 +22,80 @@ void MyEventAction::BeginOfEventAction(const G4Event *anEvent) {
 };
 
 void MyEventAction::EndOfEventAction(const G4Event *anEvent) {
+
+    Record(anEvent);
+    MyRunSummary::Instance()->EndOfEvent();
+    MyCheckpoint::Instance()->EndOfEvent(anEvent);
 };
 
+void MyEventAction::Record(const G4Event *anEvent) {
+
+    MyHitWriter *writer = MyHitWriter::Instance();
+
+    MyCrystalHitsCollection *hits = nullptr;
+    G4HCofThisEvent *hce = anEvent->GetHCofThisEvent();
+    if (hce) {
+        if (fHCID < 0) fHCID = G4SDManager::GetSDMpointer()->GetCollectionID("SensitiveDetector/CrystalHits");
+        hits = static_cast<MyCrystalHitsCollection*>(hce->GetHC(fHCID));
+    }
+    G4bool hasHits = hits && hits->entries() > 0;
+
+    // The primaries are only committed now that the event is known to be kept
+    MyHitWriter::PrimaryLog primaryLog = writer->GetPrimaryLog();
+    if (primaryLog == MyHitWriter::kLogAll || (primaryLog == MyHitWriter::kLogHit && hasHits))
+        writer->FillPrimaries(anEvent);
+
+    if (!hasHits) return;
+
+    G4int evt = anEvent->GetEventID();
+
+    MyRunSummary *summary = MyRunSummary::Instance();
+    MyHistograms *histograms = MyHistograms::Instance();
+    G4bool fillHistograms = histograms->IsActive();
+
+    fDeposits.clear();
+    G4double totalEdep  = 0.;
+    G4double totalWEdep = 0.;
+    fCopies.clear();
+
+    for (std::size_t i = 0; i < hits->entries(); ++i) {
+        const MyCrystalHit *hit = (*hits)[i];
+        writer->FillTrack(evt, hit);
+        if (fillHistograms && hit->GetEntered())
+            histograms->FillEntry(hit->GetPDG(), hit->GetKinetic(), hit->GetWeight());
+        totalEdep  += hit->GetEdep();
+        totalWEdep += hit->GetWeight() * hit->GetEdep();
+        summary->AddDeposit(hit->GetCopyNo(), hit->GetWeight() * hit->GetEdep());
+
+        // Only a handful of (copy, particle) pairs per event: linear search
+        Deposit *dep = nullptr;
+        for (auto &d : fDeposits) {
+            if (d.copyNo == hit->GetCopyNo() && d.pdg == hit->GetPDG()) { dep = &d; break; }
+        }
+        if (!dep) {
+            fDeposits.push_back({hit->GetCopyNo(), hit->GetPDG(), 0., 0., 0});
+            dep = &fDeposits.back();
+            if (std::find(fCopies.begin(), fCopies.end(), hit->GetCopyNo()) == fCopies.end())
+                fCopies.push_back(hit->GetCopyNo());
+        }
+        dep->edep  += hit->GetEdep();
+        dep->wEdep += hit->GetWeight() * hit->GetEdep();
+        dep->nTracks++;
+    }
+
+    for (const auto &d : fDeposits) {
+        writer->FillDeposit(evt, d.copyNo, d.pdg, d.edep, d.wEdep, d.nTracks);
+    }
+
+    if (fillHistograms) {
+        for (G4int copyNo : fCopies) {
+            G4double edep = 0., wEdep = 0.;
+            for (const auto &d : fDeposits) {
+                if (d.copyNo == copyNo) { edep += d.edep; wEdep += d.wEdep; }
+            }
+            histograms->FillDeposit(copyNo, edep, wEdep);
+        }
+    }
+
+    writer->FillEvent(evt, static_cast<G4int>(hits->entries()), static_cast<G4int>(fCopies.size()), totalEdep, totalWEdep);
+}
@@ -0,0 +1,252 @@
+#include "MyHistograms.hh"
+
+#include "G4AnalysisManager.hh"
+#include "G4Box.hh"
+#include "G4CsvAnalysisReader.hh"
+#include "G4LogicalVolume.hh"
+#include "G4NavigationHistory.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4VTouchable.hh"
+#include "tools/wcsv_histo"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+static const char* kSpeciesName[] = {"neutron", "gamma", "electron", "proton", "alpha", "other"};
+
+MyHistograms* MyHistograms::Instance() {
+    static G4ThreadLocal MyHistograms* instance = nullptr;
+    if (!instance) instance = new MyHistograms();
+    return instance;
+}
+
+MyHistograms::MyHistograms()
+    : fActive(false), fEdepCopyID(-1), fDepthEdepID(-1) {
+    std::fill(fEntryID, fEntryID + kNSpecies, -1);
+}
+
+G4int MyHistograms::Species(G4int pdg) {
+    switch (pdg) {
+        case 2112:       return 0;
+        case 22:         return 1;
+        case 11:
+        case -11:        return 2;  // e+ too
+        case 2212:       return 3;
+        case 1000020040: return 4;
+        default:         return kNSpecies - 1;
+    }
+}
+
+void MyHistograms::Book() {
+
+    G4AnalysisManager *man = G4AnalysisManager::Instance();
+
+    fEdepCopyID = man->CreateH2("EdepCopy", "Deposit per event and crystal copy;copy;E_{dep} [MeV]",
+                                4, -0.5, 3.5, 1000, 0., 12.);
+    for (G4int s = 0; s < kNSpecies; ++s) {
+        G4String name = G4String("EntryKinetic_") + kSpeciesName[s];
+        fEntryID[s] = man->CreateH1(name, G4String("Kinetic energy at crystal entry: ") + kSpeciesName[s] + ";E_{k} [MeV]",
+                                    200, 1e-9, 20., "none", "none", "log");
+    }
+    fDepthEdepID = man->CreateH2("DepthEdep", "Step deposit versus depth in the crystal;depth [mm];E_{dep} [MeV]",
+                                 20, 0., 10., 500, 0., 12.);
+
+    // Written only while /phoenix/hist/active is set
+    man->SetH2Activation(fEdepCopyID, false);
+    for (G4int s = 0; s < kNSpecies; ++s) man->SetH1Activation(fEntryID[s], false);
+    man->SetH2Activation(fDepthEdepID, false);
+}
+
+void MyHistograms::Configure(const G4ThreeVector& edep, const G4ThreeVector& kinetic, const G4ThreeVector& depth) {
+
+    G4AnalysisManager *man = G4AnalysisManager::Instance();
+
+    man->SetH2Activation(fEdepCopyID, fActive);
+    for (G4int s = 0; s < kNSpecies; ++s) man->SetH1Activation(fEntryID[s], fActive);
+    man->SetH2Activation(fDepthEdepID, fActive);
+    if (!fActive) return;
+
+    // One x bin per crystal copy in the geometry
+    G4int nCopies = 1;
+    for (const G4VPhysicalVolume *pv : *G4PhysicalVolumeStore::GetInstance()) {
+        if (pv->GetLogicalVolume()->GetName() == "logic_Crystal")
+            nCopies = std::max(nCopies, pv->GetCopyNo() + 1);
+    }
+
+    auto bins = [](const G4ThreeVector& axis) { return std::max(1, static_cast<G4int>(axis.x())); };
+
+    // SetH1/SetH2 also empty the histograms
+    man->SetH2(fEdepCopyID, nCopies, -0.5, nCopies - 0.5, bins(edep), edep.y(), edep.z());
+    for (G4int s = 0; s < kNSpecies; ++s)
+        man->SetH1(fEntryID[s], bins(kinetic), kinetic.y(), kinetic.z(), "none", "none", "log");
+    man->SetH2(fDepthEdepID, bins(depth), depth.y(), depth.z(), bins(edep), edep.y(), edep.z());
+}
+
+void MyHistograms::FillDeposit(G4int copyNo, G4double edep, G4double wEdep) {
+    if (edep <= 0.) return;
+    G4AnalysisManager::Instance()->FillH2(fEdepCopyID, copyNo, edep, wEdep / edep);
+}
+
+void MyHistograms::FillEntry(G4int pdg, G4double kinetic, G4double weight) {
+    G4AnalysisManager::Instance()->FillH1(fEntryID[Species(pdg)], kinetic, weight);
+}
+
+void MyHistograms::FillStep(const G4Step* step) {
+
+    G4double edep = step->GetTotalEnergyDeposit();
+    if (edep <= 0.) return;
+
+    const G4StepPoint  *pre       = step->GetPreStepPoint();
+    const G4VTouchable *touchable = pre->GetTouchable();
+    const G4AffineTransform &toLocal = touchable->GetHistory()->GetTopTransform();
+
+    // Depth is measured away from the source axis (z) through the crystal
+    // centre, or downwards for a crystal on the axis
+    G4ThreeVector centre = touchable->GetTranslation();
+    G4ThreeVector outward(centre.x(), centre.y(), 0.);
+    outward = outward.mag2() > 0. ? outward.unit() : G4ThreeVector(0., 0., -1.);
+    outward = toLocal.TransformAxis(outward);
+
+    auto box = static_cast<const G4Box*>(touchable->GetSolid());
+    G4double halfDepth = std::abs(outward.x()) * box->GetXHalfLength()
+                       + std::abs(outward.y()) * box->GetYHalfLength()
+                       + std::abs(outward.z()) * box->GetZHalfLength();
+
+    G4ThreeVector mid   = 0.5 * (pre->GetPosition() + step->GetPostStepPoint()->GetPosition());
+    G4ThreeVector local = toLocal.TransformPoint(mid);
+    G4AnalysisManager::Instance()->FillH2(fDepthEdepID, local.dot(outward) + halfDepth, edep,
+                                          step->GetTrack()->GetWeight());
+}
+
+std::vector<G4String> MyHistograms::FileTags() {
+    std::vector<G4String> tags = {"h2_EdepCopy", "h2_DepthEdep"};
+    for (G4int s = 0; s < kNSpecies; ++s) tags.push_back(G4String("h1_EntryKinetic_") + kSpeciesName[s]);
+    return tags;
+}
+
+void MyHistograms::Save(const G4String& dir) const {
+
+    G4AnalysisManager *man = G4AnalysisManager::Instance();
+
+    // Full precision, so that a resumed run continues from the same sums
+    for (G4int id : {fEdepCopyID, fDepthEdepID}) {
+        std::ofstream out(dir + "/h2_" + man->GetH2Name(id) + ".csv");
+        out << std::setprecision(17);
+        const tools::histo::h2d *h = man->GetH2(id, true, false);
+        if (h) tools::wcsv::hto(out, h->s_cls(), *h);
+    }
+    for (G4int id : fEntryID) {
+        std::ofstream out(dir + "/h1_" + man->GetH1Name(id) + ".csv");
+        out << std::setprecision(17);
+        const tools::histo::h1d *h = man->GetH1(id, true, false);
+        if (h) tools::wcsv::hto(out, h->s_cls(), *h);
+    }
+}
+
+G4bool MyHistograms::Load(const G4String& dir) {
+
+    G4AnalysisManager  *man    = G4AnalysisManager::Instance();
+    G4CsvAnalysisReader *reader = G4CsvAnalysisReader::Instance();
+
+    // The edges went through text: compare them to a relative 1e-9
+    auto close = [](G4double a, G4double b) { return std::abs(a - b) <= 1e-9 * std::max(std::abs(a), std::abs(b)); };
+    auto sameAxis = [&close](const auto& a, const auto& b) {
+        return a.bins() == b.bins() && close(a.lower_edge(), b.lower_edge()) && close(a.upper_edge(), b.upper_edge());
+    };
+
+    // Everything is checked before anything is replaced
+    std::vector<std::pair<tools::histo::h1d*, const tools::histo::h1d*>> h1s;
+    std::vector<std::pair<tools::histo::h2d*, const tools::histo::h2d*>> h2s;
+    for (G4int id : {fEdepCopyID, fDepthEdepID}) {
+        G4String name = man->GetH2Name(id);
+        G4int read = reader->ReadH2(name, dir + "/h2_" + name + ".csv", "", true);
+        tools::histo::h2d *target = man->GetH2(id, true, false);
+        const tools::histo::h2d *source = read < 0 ? nullptr : reader->GetH2(read);
+        if (!target || !source || !sameAxis(target->axis_x(), source->axis_x()) ||
+            !sameAxis(target->axis_y(), source->axis_y()))
+            return false;
+        h2s.emplace_back(target, source);
+    }
+    for (G4int id : fEntryID) {
+        G4String name = man->GetH1Name(id);
+        G4int read = reader->ReadH1(name, dir + "/h1_" + name + ".csv", "", true);
+        tools::histo::h1d *target = man->GetH1(id, true, false);
+        const tools::histo::h1d *source = read < 0 ? nullptr : reader->GetH1(read);
+        if (!target || !source || !sameAxis(target->axis(), source->axis())) return false;
+        h1s.emplace_back(target, source);
+    }
+    for (auto &h : h2s) *h.first = *h.second;
+    for (auto &h : h1s) *h.first = *h.second;
+    return true;
+}
+
+G4bool MyHistograms::MergeFiles(const G4String& target, const std::vector<G4String>& parts) {
+
+    // A G4 CSV histogram: '#' header lines, a line of column names, then one
+    // row of sums (entries, Sw, Sw2, Sxw, Sx2w) per bin; all of them add up
+    std::vector<std::string> header;
+    std::vector<std::vector<G4double>> sums;
+    G4bool   found = false;
+    G4String first;
+
+    auto axes = [](const std::vector<std::string>& head) {
+        std::vector<std::string> lines;
+        for (const auto &line : head) if (line.compare(0, 5, "#axis") == 0) lines.push_back(line);
+        return lines;
+    };
+
+    for (const auto &part : parts) {
+        std::ifstream in(part);
+        if (!in.is_open()) continue;
+
+        std::vector<std::string> head;
+        std::vector<std::vector<G4double>> rows;
+        std::string line;
+        G4bool inHeader = true;
+        while (std::getline(in, line)) {
+            if (line.empty()) continue;
+            if (inHeader) {
+                head.push_back(line);
+                inHeader = (line[0] == '#');
+                continue;
+            }
+            std::vector<G4double> row;
+            std::stringstream fields(line);
+            std::string field;
+            while (std::getline(fields, field, ',')) row.push_back(std::stod(field));
+            rows.push_back(row);
+        }
+
+        if (!found) {
+            header = head;
+            sums   = rows;
+            found  = true;
+            first  = part;
+            continue;
+        }
+        if (axes(head) != axes(header) || rows.size() != sums.size()) {
+            G4cerr << "[MyHistograms] '" << part << "' has another binning than '" << first << "': not merged" << G4endl;
+            return false;
+        }
+        for (std::size_t r = 0; r < rows.size(); ++r) {
+            for (std::size_t c = 0; c < rows[r].size() && c < sums[r].size(); ++c) sums[r][c] += rows[r][c];
+        }
+    }
+    if (!found) return false;
+
+    std::ofstream out(target);
+    out << std::setprecision(17);
+    for (const auto &line : header) out << line << "\n";
+    for (const auto &row : sums) {
+        for (std::size_t c = 0; c < row.size(); ++c) out << (c ? "," : "") << row[c];
+        out << "\n";
+    }
+    return true;
+}
@@ -0,0 +1,323 @@
+#include "MyHitWriter.hh"
+#include "MyProcessDictionary.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4SystemOfUnits.hh"
+
+// A write error (e.g. a full disk) is reported as a G4Exception instead of
+// leaving an uncaught exception to terminate the job without a word
+static void ReportIOError(const char* where, const std::exception& e, G4ExceptionSeverity severity = FatalException) {
+    G4ExceptionDescription msg;
+    msg << "PHXC output failed: " << e.what();
+    G4Exception(where, "MyHitWriter001", severity, msg);
+}
+
+MyHitWriter* MyHitWriter::Instance() {
+    static G4ThreadLocal MyHitWriter* instance = nullptr;
+    if (!instance) instance = new MyHitWriter();
+    return instance;
+}
+
+MyHitWriter::MyHitWriter() : fAsync(nullptr), fUseAsync(false), fWriteSteps(false), fPrimaryLog(kLogAll), fPhaseSpace(false) {
+    for (auto &writer : fWriters) writer = nullptr;
+    for (auto &index : fAsyncTable) index = -1;
+}
+
+MyHitWriter::~MyHitWriter() {
+    // Too late to stop the run: warn only
+    CloseWriters(JustWarning);
+}
+
+const char* MyHitWriter::TableName(G4int table) {
+    static const char* names[kNTables] = {"Hits", "Tracks", "Deposits", "Events", "Primaries", "PhaseSpace"};
+    return names[table];
+}
+
+MyHitWriter::PrimaryLog MyHitWriter::ParsePrimaryLog(const G4String& mode) {
+    if (mode == "none") return kLogNone;
+    if (mode == "hits") return kLogHit;
+    return kLogAll;
+}
+
+std::vector<ColumnSpec> MyHitWriter::Schema(G4int table) {
+
+    switch (table) {
+        case kHits:
+            // Same columns as the CSV ntuple, with fixed-width types; the process
+            // columns hold codes from the <run>_processes.csv side table
+            return {
+                {"fEvent",    ColumnType::Int32},
+                {"fEntry",    ColumnType::Int8},
+                {"fPreProc",  ColumnType::Int16},
+                {"fPostProc", ColumnType::Int16},
+                {"fTrackID",  ColumnType::Int32},
+                {"fParentID", ColumnType::Int32},
+                {"fPDG",      ColumnType::Int32},
+                {"fKinetic",  ColumnType::Float64},
+                {"fEdep",     ColumnType::Float64},
+                {"fX1",       ColumnType::Float64},
+                {"fY1",       ColumnType::Float64},
+                {"fZ1",       ColumnType::Float64},
+                {"fX2",       ColumnType::Float64},
+                {"fY2",       ColumnType::Float64},
+                {"fZ2",       ColumnType::Float64},
+                {"Copy",      ColumnType::Int32},
+                {"fWeight",   ColumnType::Float64}
+            };
+        case kTracks:
+            return {
+                {"fEvent",    ColumnType::Int32},
+                {"fTrackID",  ColumnType::Int32},
+                {"fParentID", ColumnType::Int32},
+                {"fPDG",      ColumnType::Int32},
+                {"Copy",      ColumnType::Int32},
+                {"fCreator",  ColumnType::Int16},
+                {"fEntry",    ColumnType::Int8},
+                {"fKinetic",  ColumnType::Float64},
+                {"fEdep",     ColumnType::Float64},
+                {"fNSteps",   ColumnType::Int32},
+                {"fWeight",   ColumnType::Float64}
+            };
+        case kDeposits:
+            return {
+                {"fEvent",    ColumnType::Int32},
+                {"Copy",      ColumnType::Int32},
+                {"fPDG",      ColumnType::Int32},
+                {"fEdep",     ColumnType::Float64},
+                {"fNTracks",  ColumnType::Int32},
+                {"fWEdep",    ColumnType::Float64}
+            };
+        case kEvents:
+            return {
+                {"fEvent",    ColumnType::Int32},
+                {"fNTracks",  ColumnType::Int32},
+                {"fNCopies",  ColumnType::Int32},
+                {"fEdep",     ColumnType::Float64},
+                {"fWEdep",    ColumnType::Float64}
+            };
+        case kPrimaries:
+            return {
+                {"fEvent",    ColumnType::Int32},
+                {"fPDG",      ColumnType::Int32},
+                {"fKinetic",  ColumnType::Float64},  // MeV
+                {"fDirX",     ColumnType::Float64},
+                {"fDirY",     ColumnType::Float64},
+                {"fDirZ",     ColumnType::Float64}
+            };
+        case kPhaseSpace:
+            // Rows of one source event are consecutive
+            return {
+                {"fEvent",    ColumnType::Int32},
+                {"fPDG",      ColumnType::Int32},
+                {"fX",        ColumnType::Float64},  // mm
+                {"fY",        ColumnType::Float64},
+                {"fZ",        ColumnType::Float64},
+                {"fDirX",     ColumnType::Float64},
+                {"fDirY",     ColumnType::Float64},
+                {"fDirZ",     ColumnType::Float64},
+                {"fKinetic",  ColumnType::Float64},  // MeV
+                {"fWeight",   ColumnType::Float64},
+                {"fTime",     ColumnType::Float64}   // ns
+            };
+    }
+    return {};
+}
+
+void MyHitWriter::BookNtuples() {
+
+    G4AnalysisManager *man = G4AnalysisManager::Instance();
+
+    for (G4int table = 0; table < kNTables; ++table) {
+        man->CreateNtuple(TableName(table), TableName(table));
+        for (const auto &col : Schema(table)) {
+            // The legacy Hits ntuple keeps process names
+            G4bool procName = (table == kHits && (col.name == "fPreProc" || col.name == "fPostProc"));
+            if (procName)                                  man->CreateNtupleSColumn(col.name);
+            else if (col.type == ColumnType::Float64 ||
+                     col.type == ColumnType::Float32)      man->CreateNtupleDColumn(col.name);
+            else                                           man->CreateNtupleIColumn(col.name);
+        }
+        man->FinishNtuple(table);
+    }
+}
+
+void MyHitWriter::Open(const G4String& base, const G4String& suffix,
+                       const std::vector<std::uint64_t>& resumeAt) {
+    Close();
+    if (fUseAsync) fAsync = new AsyncColumnWriter();
+    try {
+        for (G4int table = 0; table < kNTables; ++table) {
+            if (table == kHits && !fWriteSteps) continue;
+            if (table == kPrimaries && fPrimaryLog == kLogNone) continue;
+            if (table == kPhaseSpace && !fPhaseSpace) continue;
+            G4String path = base + "_" + TableName(table) + suffix + ".phx";
+            std::uint64_t offset = table < static_cast<G4int>(resumeAt.size()) ? resumeAt[table] : 0;
+            if (fAsync)      fAsyncTable[table] = static_cast<G4int>(fAsync->addTable(path, Schema(table), offset));
+            else if (offset) fWriters[table] = ColumnWriter::resume(path, Schema(table), offset).release();
+            else             fWriters[table] = new ColumnWriter(path, Schema(table));
+        }
+        if (fAsync) fAsync->start();
+    } catch (const std::exception& e) {
+        ReportIOError("MyHitWriter::Open", e);
+    }
+}
+
+std::vector<std::uint64_t> MyHitWriter::Flush() {
+    std::vector<std::uint64_t> offsets(kNTables, 0);
+    try {
+        if (fAsync) {
+            std::vector<std::uint64_t> sizes = fAsync->flush();
+            for (G4int table = 0; table < kNTables; ++table)
+                if (fAsyncTable[table] >= 0) offsets[table] = sizes[fAsyncTable[table]];
+        }
+        for (G4int table = 0; table < kNTables; ++table)
+            if (fWriters[table]) offsets[table] = fWriters[table]->flush();
+    } catch (const std::exception& e) {
+        ReportIOError("MyHitWriter::Flush", e);
+    }
+    return offsets;
+}
+
+void MyHitWriter::Close() {
+    CloseWriters(FatalException);
+}
+
+void MyHitWriter::CloseWriters(G4ExceptionSeverity severity) {
+    if (fAsync) {
+        // Waits for the writer thread to drain the queue
+        if (fAsync->stalls() > 0) {
+            G4cout << "[MyHitWriter] Output queue was full " << fAsync->stalls() << " times for "
+                   << fAsync->rows() << " rows; the disk is the bottleneck" << G4endl;
+        }
+        try {
+            fAsync->close();
+        } catch (const std::exception& e) {
+            ReportIOError("MyHitWriter::Close", e, severity);
+        }
+        delete fAsync;
+        fAsync = nullptr;
+        for (auto &index : fAsyncTable) index = -1;
+    }
+    for (auto &writer : fWriters) {
+        if (!writer) continue;
+        try {
+            writer->close();
+        } catch (const std::exception& e) {
+            ReportIOError("MyHitWriter::Close", e, severity);
+        }
+        delete writer;
+        writer = nullptr;
+    }
+}
+
+void MyHitWriter::AddRow(G4int table) {
+    if (fAsync) fAsync->addRow(fAsyncTable[table]);
+    else if (fWriters[table]) {
+        try {
+            fWriters[table]->addRow();
+        } catch (const std::exception& e) {
+            ReportIOError("MyHitWriter::AddRow", e);
+        }
+    }
+    else G4AnalysisManager::Instance()->AddNtupleRow(table);
+}
+
+void MyHitWriter::FillStep(G4int evt, G4bool isEntry,
+                           G4int preProc, G4int postProc,
+                           G4int trackID, G4int parentID, G4int pdg,
+                           G4double kinetic, G4double edep,
+                           const G4ThreeVector& prePos, const G4ThreeVector& postPos,
+                           G4int copyNo, G4double weight) {
+
+    if (IsBinary(kHits)) {
+        Put<std::int16_t>(kHits, 2, preProc);
+        Put<std::int16_t>(kHits, 3, postProc);
+    } else {
+        MyProcessDictionary *procDict = MyProcessDictionary::Instance();
+        G4AnalysisManager::Instance()->FillNtupleSColumn(kHits, 2, procDict->Name(preProc));
+        G4AnalysisManager::Instance()->FillNtupleSColumn(kHits, 3, procDict->Name(postProc));
+    }
+
+    Put<std::int32_t>(kHits,  0, evt);
+    Put<std::int8_t> (kHits,  1, isEntry);
+    Put<std::int32_t>(kHits,  4, trackID);
+    Put<std::int32_t>(kHits,  5, parentID);
+    Put<std::int32_t>(kHits,  6, pdg);
+    Put<double>      (kHits,  7, kinetic);
+    Put<double>      (kHits,  8, edep);
+    Put<double>      (kHits,  9, prePos[0]);
+    Put<double>      (kHits, 10, prePos[1]);
+    Put<double>      (kHits, 11, prePos[2]);
+    Put<double>      (kHits, 12, postPos[0]);
+    Put<double>      (kHits, 13, postPos[1]);
+    Put<double>      (kHits, 14, postPos[2]);
+    Put<std::int32_t>(kHits, 15, copyNo);
+    Put<double>      (kHits, 16, weight);
+    AddRow(kHits);
+}
+
+void MyHitWriter::FillTrack(G4int evt, const MyCrystalHit* hit) {
+    Put<std::int32_t>(kTracks, 0, evt);
+    Put<std::int32_t>(kTracks, 1, hit->GetTrackID());
+    Put<std::int32_t>(kTracks, 2, hit->GetParentID());
+    Put<std::int32_t>(kTracks, 3, hit->GetPDG());
+    Put<std::int32_t>(kTracks, 4, hit->GetCopyNo());
+    Put<std::int16_t>(kTracks, 5, hit->GetCreator());
+    Put<std::int8_t> (kTracks, 6, hit->GetEntered());
+    Put<double>      (kTracks, 7, hit->GetKinetic());
+    Put<double>      (kTracks, 8, hit->GetEdep());
+    Put<std::int32_t>(kTracks, 9, hit->GetNSteps());
+    Put<double>      (kTracks,10, hit->GetWeight());
+    AddRow(kTracks);
+}
+
+void MyHitWriter::FillDeposit(G4int evt, G4int copyNo, G4int pdg, G4double edep, G4double wEdep, G4int nTracks) {
+    Put<std::int32_t>(kDeposits, 0, evt);
+    Put<std::int32_t>(kDeposits, 1, copyNo);
+    Put<std::int32_t>(kDeposits, 2, pdg);
+    Put<double>      (kDeposits, 3, edep);
+    Put<std::int32_t>(kDeposits, 4, nTracks);
+    Put<double>      (kDeposits, 5, wEdep);
+    AddRow(kDeposits);
+}
+
+void MyHitWriter::FillEvent(G4int evt, G4int nTracks, G4int nCopies, G4double edep, G4double wEdep) {
+    Put<std::int32_t>(kEvents, 0, evt);
+    Put<std::int32_t>(kEvents, 1, nTracks);
+    Put<std::int32_t>(kEvents, 2, nCopies);
+    Put<double>      (kEvents, 3, edep);
+    Put<double>      (kEvents, 4, wEdep);
+    AddRow(kEvents);
+}
+
+void MyHitWriter::FillPrimaries(const G4Event* event) {
+    G4int evt = event->GetEventID();
+    for (G4int v = 0; v < event->GetNumberOfPrimaryVertex(); ++v) {
+        for (const G4PrimaryParticle *p = event->GetPrimaryVertex(v)->GetPrimary(); p; p = p->GetNext()) {
+            const G4ThreeVector &dir = p->GetMomentumDirection();
+            Put<std::int32_t>(kPrimaries, 0, evt);
+            Put<std::int32_t>(kPrimaries, 1, p->GetPDGcode());
+            Put<double>      (kPrimaries, 2, p->GetKineticEnergy() / MeV);
+            Put<double>      (kPrimaries, 3, dir.x());
+            Put<double>      (kPrimaries, 4, dir.y());
+            Put<double>      (kPrimaries, 5, dir.z());
+            AddRow(kPrimaries);
+        }
+    }
+}
+
+void MyHitWriter::FillPhaseSpace(G4int evt, G4int pdg, const G4ThreeVector& pos, const G4ThreeVector& dir,
+                                 G4double kinetic, G4double weight, G4double time) {
+    Put<std::int32_t>(kPhaseSpace,  0, evt);
+    Put<std::int32_t>(kPhaseSpace,  1, pdg);
+    Put<double>      (kPhaseSpace,  2, pos.x() / mm);
+    Put<double>      (kPhaseSpace,  3, pos.y() / mm);
+    Put<double>      (kPhaseSpace,  4, pos.z() / mm);
+    Put<double>      (kPhaseSpace,  5, dir.x());
+    Put<double>      (kPhaseSpace,  6, dir.y());
+    Put<double>      (kPhaseSpace,  7, dir.z());
+    Put<double>      (kPhaseSpace,  8, kinetic / MeV);
+    Put<double>      (kPhaseSpace,  9, weight);
+    Put<double>      (kPhaseSpace, 10, time / ns);
+    AddRow(kPhaseSpace);
+}
@@ -0,0 +1,152 @@
+#include "MyJobLauncher.hh"
+#include "MyHistograms.hh"
+#include "MyHitWriter.hh"
+#include "MyRunAction.hh"
+#include "MyVoxelScorer.hh"
+
+#include "ColumnFile.hh"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::vector<pid_t> children;
+G4bool forkFailed = false;
+
+G4String fileContents(const G4String& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+}
+
+G4String MyJobLauncher::JobDirectory(const G4String& outputDir, G4int job) {
+    G4String dir = outputDir;
+    if (!dir.empty() && dir.back() != '/') dir += '/';
+    return dir + "job" + std::to_string(job);
+}
+
+G4int MyJobLauncher::Fork(const G4String& outputDir, G4int nJobs) {
+
+    // Nothing buffered may be written twice
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+
+    for (G4int job = 0; job < nJobs; ++job) {
+        G4String dir = JobDirectory(outputDir, job);
+        std::error_code ec;
+        fs::create_directories(dir.c_str(), ec);
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            G4cerr << "[MyJobLauncher] Could not start job " << job << G4endl;
+            forkFailed = true;
+            break;
+        }
+        if (pid == 0) {
+            int fd = open((dir + "/job.log").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd >= 0) {
+                dup2(fd, STDOUT_FILENO);
+                dup2(fd, STDERR_FILENO);
+                close(fd);
+            }
+            return job;
+        }
+        children.push_back(pid);
+        G4cout << "[MyJobLauncher] Job " << job << ": pid " << pid << ", output in '" << dir << "'" << G4endl;
+    }
+    return -1;
+}
+
+G4bool MyJobLauncher::Wait() {
+
+    G4bool ok = !forkFailed;
+    for (std::size_t job = 0; job < children.size(); ++job) {
+        int status = 0;
+        if (waitpid(children[job], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            G4cerr << "[MyJobLauncher] Job " << job << " failed; see its job.log" << G4endl;
+            ok = false;
+        }
+    }
+    children.clear();
+    return ok;
+}
+
+G4bool MyJobLauncher::Merge(const G4String& outputDir, G4int nJobs) {
+
+    G4String base = outputDir;
+    if (!base.empty() && base.back() != '/') base += '/';
+
+    auto jobFiles = [&](const G4String& name) {
+        std::vector<G4String> parts;
+        for (G4int job = 0; job < nJobs; ++job) {
+            G4String path = JobDirectory(outputDir, job) + "/" + name;
+            if (fs::exists(path.c_str())) parts.push_back(path);
+        }
+        return parts;
+    };
+
+    // Files every job writes alike: job 0's copy, with a warning if another differs
+    auto copyCommon = [&](const G4String& name) {
+        std::vector<G4String> parts = jobFiles(name);
+        if (parts.empty()) return false;
+        G4String contents = fileContents(parts[0]);
+        for (std::size_t k = 1; k < parts.size(); ++k) {
+            if (fileContents(parts[k]) != contents)
+                G4cout << "[MyJobLauncher] '" << parts[k] << "' differs from '" << parts[0] << "'" << G4endl;
+        }
+        std::ofstream(base + name, std::ios::binary) << contents;
+        return true;
+    };
+
+    copyCommon("geo_params.csv");
+
+    G4int nRuns = 0;
+    try {
+        // The master writes the processes table of every run, whatever the format
+        for (G4int run = 0; copyCommon("output" + std::to_string(run) + "_processes.csv"); ++run) {
+            G4String prefix = "output" + std::to_string(run);
+
+            for (G4int table = 0; table < MyHitWriter::kNTables; ++table) {
+                G4String phx = prefix + "_" + MyHitWriter::TableName(table) + ".phx";
+                std::vector<G4String> parts = jobFiles(phx);
+                if (!parts.empty()) mergeColumnFiles(base + phx, std::vector<std::string>(parts.begin(), parts.end()));
+
+                G4String csv = prefix + "_nt_" + MyHitWriter::TableName(table) + ".csv";
+                parts = jobFiles(csv);
+                if (!parts.empty() && !MyRunAction::MergeTextFiles(base + csv, parts, true, false)) {
+                    throw std::runtime_error("could not write " + base + csv);
+                }
+            }
+            MyVoxelScorer::MergeFiles(base + prefix + "_Voxels.phx", jobFiles(prefix + "_Voxels.phx"));
+            for (const auto &tag : MyHistograms::FileTags()) {
+                G4String name = prefix + "_" + tag + ".csv";
+                MyHistograms::MergeFiles(base + name, jobFiles(name));
+            }
+            ++nRuns;
+        }
+    } catch (const std::exception& e) {
+        G4cerr << "[MyJobLauncher] Merge failed: " << e.what() << G4endl;
+        return false;
+    }
+
+    G4cout << "[MyJobLauncher] Merged " << nRuns << " runs of " << nJobs << " jobs into '" << outputDir << "'" << G4endl;
+    return true;
+}
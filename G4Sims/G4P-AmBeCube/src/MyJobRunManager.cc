@@ -0,0 +1,45 @@
+#include "MyJobRunManager.hh"
+
+#include "G4Event.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+
+MyJobRunManager::MyJobRunManager(G4int job, G4int nJobs)
+    : MyResumeRunManager(), fJob(job), fNJobs(nJobs) {
+}
+
+MyJobRunManager* MyJobRunManager::Instance() {
+    return dynamic_cast<MyJobRunManager*>(G4RunManager::GetRunManager());
+}
+
+void MyJobRunManager::BeamOn(G4int nEvents, const char* macroFile, G4int nSelect) {
+
+    // beamOn 0 only initialises; every job does it
+    if (nEvents <= 0) {
+        G4RunManager::BeamOn(nEvents, macroFile, nSelect);
+        return;
+    }
+
+    // The first nEvents % K jobs take one event more
+    G4int share = nEvents / fNJobs + (fJob < nEvents % fNJobs ? 1 : 0);
+    G4int first = fJob * (nEvents / fNJobs) + std::min(fJob, nEvents % fNJobs);
+    SeedJob();
+
+    G4cout << "[MyJobRunManager] Job " << fJob << " of " << fNJobs << ": events " << first
+           << " to " << first + share - 1 << " of " << nEvents << G4endl;
+    RunEvents(share, first, macroFile, nSelect);
+
+    // An empty share is a fake run, which takes no run ID; keep the run IDs,
+    // and so the output names, of all jobs in step
+    if (share == 0) ++runIDCounter;
+}
+
+void MyJobRunManager::SeedJob() {
+
+    // The first seed comes from the engine as the macro left it (the same
+    // in every job before the first run); the second is the job number.
+    // Distinct seed pairs give MixMax, the default engine, disjoint streams.
+    long seeds[3] = {1 + static_cast<long>(G4UniformRand() * 2147483646.), fJob + 1, 0};
+    G4Random::setTheSeeds(seeds);
+}
@@ -0,0 +1,74 @@
+#include "MyNeutronPhysics.hh"
+
+#include "G4Alpha.hh"
+#include "G4Deuteron.hh"
+#include "G4GenericIon.hh"
+#include "G4He3.hh"
+#include "G4Neutron.hh"
+#include "G4Proton.hh"
+#include "G4Triton.hh"
+
+#include "G4HadronElasticProcess.hh"
+#include "G4HadronInelasticProcess.hh"
+#include "G4NeutronCaptureProcess.hh"
+#include "G4NeutronGeneralProcess.hh"
+#include "G4ParticleHPCapture.hh"
+#include "G4ParticleHPCaptureData.hh"
+#include "G4ParticleHPElastic.hh"
+#include "G4ParticleHPElasticData.hh"
+#include "G4ParticleHPInelastic.hh"
+#include "G4ParticleHPInelasticData.hh"
+#include "G4PhysicsListHelper.hh"
+#include "G4SystemOfUnits.hh"
+
+MyNeutronPhysics::MyNeutronPhysics(G4bool useGeneralProcess)
+    : G4VPhysicsConstructor("PhoenixNeutronHP"), fUseGeneralProcess(useGeneralProcess) {
+}
+
+void MyNeutronPhysics::ConstructParticle() {
+    // Neutrons and everything their reactions in the geometry produce
+    G4Neutron::Definition();
+    G4Proton::Definition();
+    G4Deuteron::Definition();
+    G4Triton::Definition();
+    G4He3::Definition();
+    G4Alpha::Definition();
+    G4GenericIon::Definition();
+}
+
+void MyNeutronPhysics::ConstructProcess() {
+
+    const G4double maxEnergy = 20.*MeV;  // end of the ParticleHP data
+    G4ParticleDefinition *neutron = G4Neutron::Definition();
+
+    auto elasticModel = new G4ParticleHPElastic();
+    elasticModel->SetMaxEnergy(maxEnergy);
+    auto elastic = new G4HadronElasticProcess();
+    elastic->AddDataSet(new G4ParticleHPElasticData());
+    elastic->RegisterMe(elasticModel);
+
+    auto inelasticModel = new G4ParticleHPInelastic();
+    inelasticModel->SetMaxEnergy(maxEnergy);
+    auto inelastic = new G4HadronInelasticProcess("neutronInelastic", neutron);
+    inelastic->AddDataSet(new G4ParticleHPInelasticData());
+    inelastic->RegisterMe(inelasticModel);
+
+    auto captureModel = new G4ParticleHPCapture();
+    captureModel->SetMaxEnergy(maxEnergy);
+    auto capture = new G4NeutronCaptureProcess();
+    capture->AddDataSet(new G4ParticleHPCaptureData());
+    capture->RegisterMe(captureModel);
+
+    G4PhysicsListHelper *helper = G4PhysicsListHelper::GetPhysicsListHelper();
+    if (fUseGeneralProcess) {
+        auto general = new G4NeutronGeneralProcess();
+        general->SetElasticProcess(elastic);
+        general->SetInelasticProcess(inelastic);
+        general->SetCaptureProcess(capture);
+        helper->RegisterProcess(general, neutron);
+    } else {
+        helper->RegisterProcess(elastic,   neutron);
+        helper->RegisterProcess(inelastic, neutron);
+        helper->RegisterProcess(capture,   neutron);
+    }
+}
@@ -0,0 +1,80 @@
+#include "MyPhaseSpaceRecorder.hh"
+#include "MyHitWriter.hh"
+
+#include "G4Event.hh"
+#include "G4EventManager.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4Step.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Track.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4VSolid.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Steps that leave the volume end on its surface, up to the navigator's
+    // tolerance; this is well above it and well below any step
+    const G4double kSurfaceTolerance = 1.*um;
+}
+
+MyPhaseSpaceRecorder* MyPhaseSpaceRecorder::Instance() {
+    static G4ThreadLocal MyPhaseSpaceRecorder* instance = nullptr;
+    if (!instance) instance = new MyPhaseSpaceRecorder();
+    return instance;
+}
+
+MyPhaseSpaceRecorder::MyPhaseSpaceRecorder() : fActive(false), fRadius(0.), fHalfZ(0.) {
+}
+
+G4bool MyPhaseSpaceRecorder::Configure(const G4String& volumeName) {
+
+    const G4VPhysicalVolume *volume = G4PhysicalVolumeStore::GetInstance()->GetVolume(volumeName, false);
+    if (!volume) {
+        G4cout << "[MyPhaseSpaceRecorder] No physical volume '" << volumeName
+               << "'; phase-space recording is off" << G4endl;
+        fActive = false;
+        return false;
+    }
+    if (volume->GetRotation()) {
+        G4cout << "[MyPhaseSpaceRecorder] '" << volumeName << "' is rotated; the surface is "
+               << "taken along the world z axis anyway" << G4endl;
+    }
+
+    G4ThreeVector pMin, pMax;
+    volume->GetLogicalVolume()->GetSolid()->BoundingLimits(pMin, pMax);
+
+    fRadius = std::max({-pMin.x(), pMax.x(), -pMin.y(), pMax.y()});
+    fHalfZ  = 0.5 * (pMax.z() - pMin.z());
+    fCentre = volume->GetTranslation() + G4ThreeVector(0., 0., 0.5 * (pMax.z() + pMin.z()));
+    return true;
+}
+
+G4bool MyPhaseSpaceRecorder::Inside(const G4ThreeVector& pos, G4double margin) const {
+    G4ThreeVector d = pos - fCentre;
+    G4double r = fRadius + margin;
+    return d.x() * d.x() + d.y() * d.y() <= r * r && std::abs(d.z()) <= fHalfZ + margin;
+}
+
+void MyPhaseSpaceRecorder::Step(const G4Step* step) {
+
+    const G4StepPoint *pre  = step->GetPreStepPoint();
+    const G4StepPoint *post = step->GetPostStepPoint();
+
+    // Only steps from inside the surface onto or past it
+    if (!Inside(pre->GetPosition(), kSurfaceTolerance)) return;
+    if (Inside(post->GetPosition(), -kSurfaceTolerance)) return;
+
+    G4Track *track = step->GetTrack();
+    const G4Event *event = G4EventManager::GetEventManager()->GetConstCurrentEvent();
+
+    MyHitWriter::Instance()->FillPhaseSpace(event ? event->GetEventID() : -1,
+                                            track->GetDefinition()->GetPDGEncoding(),
+                                            post->GetPosition(), post->GetMomentumDirection(),
+                                            post->GetKineticEnergy(), post->GetWeight(),
+                                            post->GetGlobalTime());
+
+    // Transport beyond the surface is left to the replay runs
+    track->SetTrackStatus(fStopAndKill);
+}
@@ -0,0 +1,133 @@
+#include "MyPhaseSpaceSource.hh"
+#include "MyJobRunManager.hh"
+
+#include "ColumnFile.hh"
+
+#include "G4AutoLock.hh"
+#include "G4Event.hh"
+#include "G4IonTable.hh"
+#include "G4ParticleTable.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4ThreeVector.hh"
+#include "Randomize.hh"
+
+#include <map>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+
+G4Mutex phaseSpaceMutex = G4MUTEX_INITIALIZER;
+
+// Tables by path, for the lifetime of the process
+std::map<std::string, std::unique_ptr<MyPhaseSpaceSource::Table>>& loadedTables() {
+    static std::map<std::string, std::unique_ptr<MyPhaseSpaceSource::Table>> loaded;
+    return loaded;
+}
+
+std::unique_ptr<MyPhaseSpaceSource::Table> readTable(const std::string& path) {
+
+    ColumnReader reader(path);
+    auto table = std::make_unique<MyPhaseSpaceSource::Table>();
+    table->path    = path;
+    std::vector<std::int32_t> event = reader.column<std::int32_t>("fEvent");
+    table->pdg     = reader.column<std::int32_t>("fPDG");
+    table->x       = reader.column<double>("fX");
+    table->y       = reader.column<double>("fY");
+    table->z       = reader.column<double>("fZ");
+    table->dirX    = reader.column<double>("fDirX");
+    table->dirY    = reader.column<double>("fDirY");
+    table->dirZ    = reader.column<double>("fDirZ");
+    table->kinetic = reader.column<double>("fKinetic");
+    table->weight  = reader.column<double>("fWeight");
+    table->time    = reader.column<double>("fTime");
+
+    // The rows of a source event are consecutive, also after the thread merge
+    for (std::size_t row = 0; row < event.size(); ++row) {
+        if (row == 0 || event[row] != event[row - 1]) table->groupStart.push_back(row);
+    }
+    if (table->groupStart.empty()) throw std::runtime_error(path + ": no particles");
+    table->groupStart.push_back(event.size());
+    return table;
+}
+
+}
+
+MyPhaseSpaceSource::MyPhaseSpaceSource(const G4String& path)
+    : fTable(nullptr), fRecycle(1), fGroup(0), fUses(0) {
+
+    G4AutoLock lock(&phaseSpaceMutex);
+    auto &loaded = loadedTables();
+    auto it = loaded.find(path);
+    if (it == loaded.end()) {
+        it = loaded.emplace(path, readTable(path)).first;
+        G4cout << "[MyPhaseSpaceSource] " << it->second->pdg.size() << " particles in "
+               << it->second->groupStart.size() - 1 << " source events from " << path << G4endl;
+
+        // Each job of a --jobs launch starts on its own slice of the table
+        const MyJobRunManager *job = MyJobRunManager::Instance();
+        if (job) {
+            std::size_t nGroups = it->second->groupStart.size() - 1;
+            it->second->next = nGroups * job->GetJob() / job->GetNumberOfJobs();
+        }
+    }
+    fTable = it->second.get();
+}
+
+std::size_t MyPhaseSpaceSource::GetNumberOfGroups() const {
+    return fTable->groupStart.size() - 1;
+}
+
+void MyPhaseSpaceSource::GetCursor(std::uint64_t& next, std::size_t& group, G4int& uses) const {
+    next  = fTable->next.load();
+    group = fGroup;
+    uses  = fUses;
+}
+
+void MyPhaseSpaceSource::SetCursor(std::uint64_t next, std::size_t group, G4int uses) {
+    fTable->next = next;
+    fGroup = group < GetNumberOfGroups() ? group : 0;
+    fUses  = uses;
+}
+
+void MyPhaseSpaceSource::GeneratePrimaries(G4Event* event) {
+
+    const std::size_t nGroups = GetNumberOfGroups();
+    if (fUses == 0 || fUses >= fRecycle) {
+        std::uint64_t next = fTable->next.fetch_add(1, std::memory_order_relaxed);
+        if (next == nGroups) {
+            G4cout << "[MyPhaseSpaceSource] All " << nGroups << " source events of " << fTable->path
+                   << " used; starting over, later events are correlated with earlier ones" << G4endl;
+        }
+        fGroup = static_cast<std::size_t>(next % nGroups);
+        fUses  = 0;
+    }
+    ++fUses;
+
+    const G4double phi = twopi * G4UniformRand();
+    G4ParticleTable *particles = G4ParticleTable::GetParticleTable();
+
+    for (std::size_t row = fTable->groupStart[fGroup]; row < fTable->groupStart[fGroup + 1]; ++row) {
+        G4int pdg = fTable->pdg[row];
+        G4ParticleDefinition *definition = particles->FindParticle(pdg);
+        if (!definition) definition = G4IonTable::GetIonTable()->GetIon(pdg);
+        if (!definition) continue;
+
+        G4ThreeVector position(fTable->x[row] * mm, fTable->y[row] * mm, fTable->z[row] * mm);
+        G4ThreeVector direction(fTable->dirX[row], fTable->dirY[row], fTable->dirZ[row]);
+        position.rotateZ(phi);
+        direction.rotateZ(phi);
+
+        auto primary = new G4PrimaryParticle(definition);
+        primary->SetKineticEnergy(fTable->kinetic[row] * MeV);
+        primary->SetMomentumDirection(direction);
+        primary->SetWeight(fTable->weight[row]);
+
+        auto vertex = new G4PrimaryVertex(position, fTable->time[row] * ns);
+        vertex->SetPrimary(primary);
+        event->AddPrimaryVertex(vertex);
+    }
+}
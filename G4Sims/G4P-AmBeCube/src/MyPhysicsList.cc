@@ -1,12 +1,227 @@
 #include "MyPhysicsList.hh"
+#include "MyPhysicsCache.hh"
+#include "MyNeutronPhysics.hh"
 
-MyPhysicsList::MyPhysicsList(){
+#include "G4EmParameters.hh"
+#include "G4GeometrySampler.hh"
+#include "G4ImportanceBiasing.hh"
+#include "G4IStore.hh"
+#include "G4Navigator.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
+#include "G4TransportationManager.hh"
+
+MyPhysicsList::MyPhysicsList()
+    : fProfile("reference"), fHadronElastic(new G4HadronElasticPhysicsHP()),
+      fHadronInelastic(new G4HadronPhysicsQGSP_BIC_HP()), fNeutronPhysics(new MyNeutronPhysics()),
+      fInitStart(std::chrono::steady_clock::now()), fSampler(nullptr) {
     RegisterPhysics (new G4EmStandardPhysics());
     RegisterPhysics (new G4DecayPhysics());
-    RegisterPhysics (new G4HadronElasticPhysicsHP());
-    RegisterPhysics (new G4HadronPhysicsQGSP_BIC_HP());
+    RegisterPhysics (fHadronElastic);
+    RegisterPhysics (fHadronInelastic);
     //RegisterPhysics (new G4NeutronTrackingCut());
+
+    fMessengerPhysics = new G4GenericMessenger(this,
+                                               "/phoenix/physics/",
+                                               "Physics profile");
+
+    fMessengerPhysics->DeclareMethod("profile",
+                                     &MyPhysicsList::SetProfile,
+                                     "reference (QGSP_BIC_HP) or fast (neutron HP only, gamma general process)")
+                     .SetCandidates("reference fast")
+                     .SetStates(G4State_PreInit)
+                     .SetToBeBroadcasted(false);
+
+    fMessengerPhysics->DeclareMethod("neutronGeneral",
+                                     &MyPhysicsList::SetNeutronGeneralProcess,
+                                     "Fast profile: one general process for the neutron HP processes")
+                     .SetStates(G4State_PreInit)
+                     .SetToBeBroadcasted(false);
+
+    fMessenger = new G4GenericMessenger(this,
+                                        "/phoenix/bias/",
+                                        "Neutron importance biasing");
+
+    // The physics list is shared by all threads: set it once, on the master
+    fMessenger->DeclareMethod("importance",
+                              &MyPhysicsList::SetImportance,
+                              "Neutron importance of a physical volume (before /run/initialize)")
+              .SetStates(G4State_PreInit)
+              .SetToBeBroadcasted(false);
+
+    // Fine where dose is scored, coarse where it is not: secondaries below
+    // the cut deposit their energy on the spot instead of being tracked
+    fRegionCuts["Crystals"]     = 0.1*mm;
+    fRegionCuts["SourceShield"] = 1.*mm;
+    fRegionCuts["Structure"]    = 1.*cm;
+
+    fMessengerCuts = new G4GenericMessenger(this,
+                                            "/phoenix/cuts/",
+                                            "Production cuts per region");
+
+    fMessengerCuts->DeclareMethodWithUnit("crystals", "mm",
+                                          &MyPhysicsList::SetCrystalsCut,
+                                          "Range cut in the LiF crystals (before /run/initialize)")
+                  .SetStates(G4State_PreInit)
+                  .SetToBeBroadcasted(false);
+
+    fMessengerCuts->DeclareMethodWithUnit("shield", "mm",
+                                          &MyPhysicsList::SetSourceShieldCut,
+                                          "Range cut in the Pb source shield (before /run/initialize)")
+                  .SetStates(G4State_PreInit)
+                  .SetToBeBroadcasted(false);
+
+    fMessengerCuts->DeclareMethodWithUnit("structure", "mm",
+                                          &MyPhysicsList::SetStructureCut,
+                                          "Range cut in the floor and frame (before /run/initialize)")
+                  .SetStates(G4State_PreInit)
+                  .SetToBeBroadcasted(false);
 };
 
 MyPhysicsList::~MyPhysicsList(){
+    delete fMessenger;
+    delete fMessengerCuts;
+    delete fMessengerPhysics;
+    delete fSampler;
+    // The registered constructors are deleted by G4VModularPhysicsList
+    if (fProfile == "fast") {
+        delete fHadronElastic;
+        delete fHadronInelastic;
+    } else {
+        delete fNeutronPhysics;
+    }
 };
+
+void MyPhysicsList::SetImportance(G4String volume, G4double importance) {
+
+    if (importance <= 0.) {
+        G4cout << "[MyPhysicsList] Importance of '" << volume << "' must be positive" << G4endl;
+        return;
+    }
+
+    if (!fSampler) {
+        // The world is only known once the geometry is built, see ConstructProcess
+        fSampler = new G4GeometrySampler(nullptr, "neutron");
+        fSampler->SetParallel(false);
+        RegisterPhysics(new G4ImportanceBiasing(fSampler));
+    }
+    fImportance[volume] = importance;
+}
+
+void MyPhysicsList::SetRegionCut(const G4String& region, G4double cut) {
+
+    if (cut <= 0.) {
+        G4cout << "[MyPhysicsList] Cut of region '" << region << "' must be positive" << G4endl;
+        return;
+    }
+    fRegionCuts[region] = cut;
+}
+
+void MyPhysicsList::SetProfile(G4String profile) {
+
+    if (profile != "reference" && profile != "fast") {
+        G4cout << "[MyPhysicsList] Unknown physics profile '" << profile << "' (reference|fast)" << G4endl;
+        return;
+    }
+    if (profile == fProfile) return;
+
+    if (profile == "fast") {
+        RemovePhysics(fHadronElastic);
+        RemovePhysics(fHadronInelastic);
+        RegisterPhysics(fNeutronPhysics);
+    } else {
+        RemovePhysics(fNeutronPhysics);
+        RegisterPhysics(fHadronElastic);
+        RegisterPhysics(fHadronInelastic);
+    }
+    // One gamma process looking up a single total cross section per step
+    G4EmParameters::Instance()->SetGeneralProcessActive(profile == "fast");
+    fProfile = profile;
+}
+
+void MyPhysicsList::SetNeutronGeneralProcess(G4bool value) {
+    fNeutronPhysics->SetGeneralProcess(value);
+}
+
+G4double MyPhysicsList::GetInitSeconds() const {
+    return std::chrono::duration<G4double>(std::chrono::steady_clock::now() - fInitStart).count();
+}
+
+void MyPhysicsList::ConstructParticle() {
+    G4VModularPhysicsList::ConstructParticle();
+    // Particles are built once, when the list is handed to the run manager,
+    // so the inactive profile's must exist too
+    if (fProfile == "fast") fHadronInelastic->ConstructParticle();
+    else                    fNeutronPhysics->ConstructParticle();
+}
+
+void MyPhysicsList::ConstructProcess() {
+
+    if (G4Threading::IsMasterThread()) fInitStart = std::chrono::steady_clock::now();
+
+    if (fSampler) {
+        G4Navigator *navigator = G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
+        fSampler->SetWorld(navigator->GetWorldVolume());
+    }
+
+    G4VModularPhysicsList::ConstructProcess();
+
+    // Every thread builds its own importance store
+    if (fSampler) CreateImportanceStore();
+}
+
+void MyPhysicsList::SetCuts() {
+
+    G4VModularPhysicsList::SetCuts();
+
+    // Regions are shared by all threads: set them once, on the master
+    if (G4Threading::IsMasterThread()) ApplyRegionCuts();
+
+    // Geometry, materials and cuts are all known by now
+    MyPhysicsCache::Instance()->Configure(this);
+}
+
+void MyPhysicsList::ApplyRegionCuts() const {
+
+    // Same cut for gammas, e-, e+ and protons of a region
+    const G4ProductionCuts *defaultCuts = G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts();
+    for (const auto &kv : fRegionCuts) {
+        G4Region *region = G4RegionStore::GetInstance()->GetRegion(kv.first, false);
+        if (!region) {
+            G4cout << "[MyPhysicsList] No region '" << kv.first << "' for production cuts" << G4endl;
+            continue;
+        }
+        G4ProductionCuts *cuts = region->GetProductionCuts();
+        if (!cuts || cuts == defaultCuts) {
+            cuts = new G4ProductionCuts();
+            region->SetProductionCuts(cuts);
+        }
+        cuts->SetProductionCut(kv.second);
+    }
+}
+
+void MyPhysicsList::CreateImportanceStore() const {
+
+    G4IStore *store = G4IStore::GetInstance();
+    store->Clear();
+
+    // Every cell the neutrons can enter needs an importance; placements are
+    // looked up by (volume, copy number)
+    for (const G4VPhysicalVolume *volume : *G4PhysicalVolumeStore::GetInstance()) {
+        G4double importance = 1.;
+        auto it = fImportance.find(volume->GetName());
+        if (it != fImportance.end()) importance = it->second;
+        store->AddImportanceGeometryCell(importance, *volume, volume->GetCopyNo());
+    }
+
+    for (const auto &kv : fImportance) {
+        if (!G4PhysicalVolumeStore::GetInstance()->GetVolume(kv.first, false)) {
+            G4cout << "[MyPhysicsList] No physical volume '" << kv.first << "' for importance biasing" << G4endl;
+        }
+    }
+}
@@ -1,4 +1,5 @@
 #include "MyPrimaryGenerator.hh"
+#include "MyPhaseSpaceSource.hh"
 #include "G4Event.hh"
 #include <string>
 
@@ -7,33 +8,19 @@
 #include "G4IonTable.hh"
 #include "G4RandomTools.hh"
 
-// PrimaryGeneratorAction.cc (snippet)
-#include "SpectrumSampler.hh"
 #include "Randomize.hh"  // G4UniformRand
+#include <stdexcept>
 
-// Build once (constructor or first call). Paste your full table:
-// Values taken from Pavel's sim
-static SpectrumSampler makeAmBeSampler() {
-  std::vector<double> E = {
-    0.0, 0.000000414, 0.11, 0.33, 0.54, 0.75, 0.97, 1.18, 1.40, 1.61,
-    1.82, 2.04, 2.25, 2.47, 2.68, 2.90, 3.11, 3.32, 3.54, 3.75,
-    3.97, 4.18, 4.39, 4.61, 4.82, 5.04, 5.25, 5.47, 5.68, 5.89,
-    6.11, 6.32, 6.54, 6.75, 6.96, 7.18, 7.39, 7.61, 7.82, 8.03,
-    8.25, 8.46, 8.68, 8.89, 9.11, 9.32, 9.53, 9.75, 9.96, 10.18,
-    10.39, 10.60, 10.82, 11.03, 11.09
-  };
-  std::vector<double> W = {
-    0.0, 0.01440, 0.03340, 0.03130, 0.02810, 0.02500, 0.02140, 0.01980, 0.01750, 0.01920,
-    0.02230, 0.02150, 0.02250, 0.02280, 0.02950, 0.03560, 0.03690, 0.03460, 0.03070, 0.03000,
-    0.02690, 0.02860, 0.03180, 0.03070, 0.03330, 0.03040, 0.02740, 0.02330, 0.02060, 0.01820,
-    0.01770, 0.02040, 0.01830, 0.01630, 0.01680, 0.01680, 0.01880, 0.01840, 0.01690, 0.01440,
-    0.00963, 0.00652, 0.00426, 0.00367, 0.00381, 0.00506, 0.00625, 0.00552, 0.00468, 0.00370,
-    0.00278, 0.00151, 0.00036, 0.00000, 0.00000
-  };
-  return SpectrumSampler(std::move(E), std::move(W));
-}
+MyPrimaryGenerator::MyPrimaryGenerator()
+    : fSpectrum(Spectra::kAmBe.view()), fSpectrumName("AmBe"), fPhaseSpace(nullptr), fRecycle(1) {
 
-MyPrimaryGenerator::MyPrimaryGenerator(const G4String& outputPath) : fOutputDirectory(outputPath) {
+    fMessengerSource = new G4GenericMessenger(this, "/MySource/", "Source settings");
+    fMessengerSource->DeclareMethod("Spectrum", &MyPrimaryGenerator::SetSpectrum,
+                                    "Neutron spectrum: AmBe, Cf252, or a .csv (E_MeV,weight) or PHXS binary file");
+    fMessengerSource->DeclareMethod("PhaseSpace", &MyPrimaryGenerator::SetPhaseSpace,
+                                    "Replay a PhaseSpace .phx table instead of the source (none: back to the source)");
+    fMessengerSource->DeclareMethod("Recycle", &MyPrimaryGenerator::SetRecycle,
+                                    "Times each recorded source event is replayed, rotated about z");
 
     // Define neutron
     fNeutronGun = new G4ParticleGun(1);
@@ -52,37 +39,52 @@ MyPrimaryGenerator::MyPrimaryGenerator(const G4String& outputPath) : fOutputDire
     fGammaGun->SetParticleDefinition(gamma);
 
     fGammaGun->SetParticlePosition(pos);
+}
 
-  // Build file paths using the provided output directory. Assume outputPath is a directory.
-  std::string outDir = std::string(fOutputDirectory);
-  if (!outDir.empty() && outDir.back() != '/') outDir.push_back('/');
-  std::string neutronPath = outDir + "generated_neutrons.csv";
-  std::string gammaPath   = outDir + "generated_gammas.csv";
-
-  // Open CSV outputs
-  fOutNeutron.open(neutronPath);
-  fOutGamma.open(gammaPath);
-
-  // Include direction columns (dir_x, dir_y, dir_z) in addition to energy
-  fOutNeutron << "event_id,E_MeV,dir_x,dir_y,dir_z\n";
-  fOutGamma   << "event_id,E_MeV,dir_x,dir_y,dir_z\n";
+MyPrimaryGenerator::~MyPrimaryGenerator(){
+  delete fNeutronGun;
+  delete fGammaGun;
+  delete fMessengerSource;
+  delete fPhaseSpace;
+}
 
+void MyPrimaryGenerator::SetSpectrum(G4String nameOrPath){
+  try {
+    fSpectrum     = SpectrumLibrary::Get(nameOrPath);
+    fSpectrumName = nameOrPath;
+  } catch (const std::exception& e) {
+    G4cerr << "MyPrimaryGenerator: cannot use spectrum '" << nameOrPath << "' (" << e.what()
+           << "), keeping " << fSpectrumName << G4endl;
+  }
+}
 
+void MyPrimaryGenerator::SetPhaseSpace(G4String path){
+  delete fPhaseSpace;
+  fPhaseSpace = nullptr;
+  if (path == "none") return;
+  try {
+    fPhaseSpace = new MyPhaseSpaceSource(path);
+    fPhaseSpace->SetRecycle(fRecycle);
+  } catch (const std::exception& e) {
+    G4cerr << "MyPrimaryGenerator: cannot replay '" << path << "' (" << e.what()
+           << "), using the source" << G4endl;
+  }
 }
 
-MyPrimaryGenerator::~MyPrimaryGenerator(){
-  if (fOutNeutron.is_open()) fOutNeutron.close();
-  if (fOutGamma.is_open()) fOutGamma.close();
-  delete fNeutronGun;
-  delete fGammaGun;  
+void MyPrimaryGenerator::SetRecycle(G4int recycle){
+  fRecycle = recycle > 0 ? recycle : 1;
+  if (fPhaseSpace) fPhaseSpace->SetRecycle(fRecycle);
 }
 
 void MyPrimaryGenerator::GeneratePrimaries(G4Event* event){
 
-    static SpectrumSampler sampler = makeAmBeSampler();
+  if (fPhaseSpace) {
+    fPhaseSpace->GeneratePrimaries(event);
+    return;
+  }
 
   const double u = G4UniformRand();
-  const double ENeutron = sampler.sample(u);
+  const double ENeutron = fSpectrum.sample(u);
 
     // Gamma energy
     G4double EGamma = 4.44 *MeV;
@@ -96,21 +98,9 @@ void MyPrimaryGenerator::GeneratePrimaries(G4Event* event){
     fNeutronGun->SetParticleEnergy(ENeutron *MeV);
     fNeutronGun->GeneratePrimaryVertex(event);
 
-    // Save neutron (event_id,E_MeV,dir_x,dir_y,dir_z)
-    G4int eventID = event->GetEventID();
-    if (fOutNeutron.is_open()) {
-        fOutNeutron << eventID << "," << ENeutron << ","
-                    << vecNeutron.x() << "," << vecNeutron.y() << "," << vecNeutron.z() << "\n";
-    }
-   
    if(G4UniformRand() < 0.6){
         fGammaGun->SetParticleMomentumDirection(vecGamma);
         fGammaGun->SetParticleEnergy(EGamma);
         fGammaGun->GeneratePrimaryVertex(event);
-        // Save gamma (event_id,E_MeV,dir_x,dir_y,dir_z)
-        if (fOutGamma.is_open()) {
-            fOutGamma << eventID << "," << (EGamma/MeV) << ","
-                      << vecGamma.x() << "," << vecGamma.y() << "," << vecGamma.z() << "\n";
-        }
     }
 }
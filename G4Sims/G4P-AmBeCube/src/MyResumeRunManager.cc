@@ -0,0 +1,38 @@
+#include "MyResumeRunManager.hh"
+#include "MyCheckpoint.hh"
+#include "MyRunAction.hh"
+
+MyResumeRunManager::MyResumeRunManager() : G4RunManager(), fEventOffset(0) {
+}
+
+void MyResumeRunManager::BeamOn(G4int nEvents, const char* macroFile, G4int nSelect) {
+    RunEvents(nEvents, 0, macroFile, nSelect);
+}
+
+void MyResumeRunManager::RunEvents(G4int nEvents, G4int eventBase, const char* macroFile, G4int nSelect) {
+
+    fEventOffset = eventBase;
+
+    // beamOn 0 only initialises
+    if (nEvents <= 0) {
+        G4RunManager::BeamOn(nEvents, macroFile, nSelect);
+        return;
+    }
+
+    const auto *runAction = dynamic_cast<const MyRunAction*>(GetUserRunAction());
+    G4bool usable = runAction && runAction->GetOutputFormat() == "phx";
+
+    G4int first = MyCheckpoint::Instance()->BeginOfBeamOn(runIDCounter, nEvents, eventBase, usable);
+    if (first < 0) {
+        // Done before the restart: its files are complete, it only takes
+        // its run ID
+        ++runIDCounter;
+        return;
+    }
+    fEventOffset += first;
+    G4RunManager::BeamOn(nEvents - first, macroFile, nSelect);
+}
+
+G4Event* MyResumeRunManager::GenerateEvent(G4int iEvent) {
+    return G4RunManager::GenerateEvent(fEventOffset + iEvent);
+}
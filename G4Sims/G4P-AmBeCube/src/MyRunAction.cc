@@ -1,60 +1,385 @@
 #include "MyRunAction.hh"
+#include "MyCheckpoint.hh"
+#include "MyDetectorConstruction.hh"
+#include "MyHistograms.hh"
+#include "MyHitWriter.hh"
+#include "MyProcessDictionary.hh"
+#include "MyPhysicsCache.hh"
+#include "MyPhysicsList.hh"
+#include "MyRunSummary.hh"
+#include "MyVoxelScorer.hh"
+#include "MyStepProfiler.hh"
+#include "MyPhaseSpaceRecorder.hh"
+#include "G4AccumulableManager.hh"
 #include "G4AnalysisManager.hh"
+#include "G4RunManager.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
+#include <cstdio> // for std::remove
+#include <fstream>
 #include <sstream>
 #include <string>
+#include <vector>
+#include <sys/resource.h>
 
-MyRunAction::MyRunAction() : outputDirectory("./") {
-    G4AnalysisManager *man = G4AnalysisManager::Instance();
+// Peak resident memory of the process so far, in MB
+static G4double peakMemoryMB() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.;
+    return usage.ru_maxrss / 1024.;  // kB on Linux
+}
+
+// The application's physics list, nullptr if another one is in use
+static const MyPhysicsList* myPhysicsList() {
+    return dynamic_cast<const MyPhysicsList*>(G4RunManager::GetRunManager()->GetUserPhysicsList());
+}
+
+G4bool MyRunAction::MergeTextFiles(const G4String& target, const std::vector<G4String>& parts,
+                                   G4bool ntupleHeader, G4bool removeParts) {
 
-    man->CreateNtuple("Hits", "Hits");
-    man->CreateNtupleIColumn("fEvent");
-    man->CreateNtupleIColumn("fEntry");   
-    man->CreateNtupleSColumn("fPreProc");
-    man->CreateNtupleSColumn("fPostProc");
-    man->CreateNtupleIColumn("fTrackID");
-    man->CreateNtupleIColumn("fParentID");
-    man->CreateNtupleIColumn("fPDG");
-    man->CreateNtupleDColumn("fKinetic");
-    man->CreateNtupleDColumn("fEdep");
-    man->CreateNtupleDColumn("fX1");
-    man->CreateNtupleDColumn("fY1");
-    man->CreateNtupleDColumn("fZ1");
-    man->CreateNtupleDColumn("fX2");
-    man->CreateNtupleDColumn("fY2");
-    man->CreateNtupleDColumn("fZ2");
-    man->CreateNtupleIColumn("Copy");
-    man->FinishNtuple(0);
+    std::ofstream out(target, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        G4cerr << "[MyRunAction] Could not open '" << target << "' for merging" << G4endl;
+        return false;
+    }
+
+    G4bool needHeader = true;
+    std::string line;
+    for (const auto &part : parts) {
+        std::ifstream in(part, std::ios::binary);
+        if (!in.is_open()) continue;
+
+        if (ntupleHeader) {
+            while (in.peek() == '#' && std::getline(in, line)) {
+                if (needHeader) out << line << '\n';
+            }
+        } else if (std::getline(in, line) && needHeader) {
+            out << line << '\n';
+        }
+        needHeader = false;
+
+        if (in.peek() != std::ifstream::traits_type::eof()) out << in.rdbuf();
+    }
+
+    // Only a complete target replaces the parts
+    out.close();
+    if (!out) {
+        G4cerr << "[MyRunAction] Could not write '" << target << "': thread files kept" << G4endl;
+        return false;
+    }
+    if (removeParts) {
+        for (const auto &part : parts) std::remove(part.c_str());
+    }
+    return true;
+}
+
+MyRunAction::MyRunAction()
+    : outputDirectory("./"), fInitSeconds(0.), fSetupSeconds(0.), fOutputFormat("phx"), fWriteSteps(false), fAsyncOutput(false), fPrimaryLog("all"),
+      fVoxelActive(false), fVoxelGrid(10, 10, 10), fProfileActive(false), fProfileTop(20),
+      fPhaseSpaceRecord(false), fPhaseSpaceVolume("phys_SourceShield"),
+      fHistActive(false), fHistEdep(1000, 0., 12.), fHistKinetic(200, 1e-9, 20.), fHistDepth(20, 0., 10.),
+      fCheckpointEvery(0) {
+
+    fSetupTimer.Start();
+
+    // Ntuples for the CSV format, one per MyHitWriter table
+    MyHitWriter::BookNtuples();
+    MyHistograms::Instance()->Book();
+
+    fMessengerOutput = new G4GenericMessenger(this,
+                                              "/phoenix/output/",
+                                              "Simulation output");
+
+    fMessengerOutput->DeclareProperty("format",
+                                      fOutputFormat,
+                                      "Output format: phx (binary columnar) or csv")
+                    .SetCandidates("phx csv");
+
+    fMessengerOutput->DeclareProperty("steps",
+                                      fWriteSteps,
+                                      "Also write the raw per-step Hits table (debug)");
+
+    fMessengerOutput->DeclareProperty("async",
+                                      fAsyncOutput,
+                                      "Encode and write PHXC tables on a writer thread per worker (default: false)");
+
+    fMessengerOutput->DeclareProperty("primaries",
+                                      fPrimaryLog,
+                                      "Log the primaries of all events, of events with crystal hits, or none")
+                    .SetCandidates("all hits none");
+
+    // Every thread registers its own grid; workers merge into the master's
+    G4AccumulableManager::Instance()->RegisterAccumulable(MyVoxelScorer::Instance());
+
+    fMessengerVoxel = new G4GenericMessenger(this,
+                                             "/phoenix/voxel/",
+                                             "Voxelised energy deposit in the crystals");
+
+    fMessengerVoxel->DeclareProperty("active",
+                                     fVoxelActive,
+                                     "Score deposits on a voxel grid over each crystal");
+
+    fMessengerVoxel->DeclareProperty("grid",
+                                     fVoxelGrid,
+                                     "Number of voxels along x y z of each crystal");
+
+    G4AccumulableManager::Instance()->RegisterAccumulable(MyStepProfiler::Instance());
+    G4AccumulableManager::Instance()->RegisterAccumulable(MyRunSummary::Instance());
+
+    fMessengerProfile = new G4GenericMessenger(this,
+                                               "/phoenix/profile/",
+                                               "Where the tracking time goes");
+
+    fMessengerProfile->DeclareProperty("active",
+                                       fProfileActive,
+                                       "Time steps by (volume, particle, process) and report at end of run");
+
+    fMessengerProfile->DeclareProperty("top",
+                                       fProfileTop,
+                                       "Number of report lines printed at end of run");
+
+    fMessengerPhaseSpace = new G4GenericMessenger(this,
+                                                  "/phoenix/phsp/",
+                                                  "Phase-space recording around the source");
+
+    fMessengerPhaseSpace->DeclareProperty("record",
+                                          fPhaseSpaceRecord,
+                                          "Write and kill every track leaving the surface (PhaseSpace table)");
+
+    fMessengerPhaseSpace->DeclareProperty("volume",
+                                          fPhaseSpaceVolume,
+                                          "Physical volume whose bounding cylinder about z is the surface");
+
+    fMessengerHist = new G4GenericMessenger(this,
+                                            "/phoenix/hist/",
+                                            "Spectra histogrammed during the run");
+
+    fMessengerHist->DeclareProperty("active",
+                                    fHistActive,
+                                    "Fill the EdepCopy, EntryKinetic_<species> and DepthEdep histograms");
+
+    fMessengerHist->DeclareProperty("edep",
+                                    fHistEdep,
+                                    "Deposit axis: bins min max (MeV)");
+
+    fMessengerHist->DeclareProperty("kinetic",
+                                    fHistKinetic,
+                                    "Log entry kinetic energy axis: bins min max (MeV, min > 0)");
+
+    fMessengerHist->DeclareProperty("depth",
+                                    fHistDepth,
+                                    "Depth axis: bins min max (mm)");
+
+    fMessengerCheckpoint = new G4GenericMessenger(this,
+                                                  "/phoenix/checkpoint/",
+                                                  "Checkpoints of long sequential runs (restart with --resume)");
+
+    fMessengerCheckpoint->DeclareProperty("every",
+                                          fCheckpointEvery,
+                                          "Save the run state every N events; 0 disables checkpoints");
 
 }
 
 MyRunAction::~MyRunAction(){
+    delete fMessengerOutput;
+    delete fMessengerVoxel;
+    delete fMessengerProfile;
+    delete fMessengerPhaseSpace;
+    delete fMessengerHist;
+    delete fMessengerCheckpoint;
+}
+
+G4String MyRunAction::RunFileBase(const G4Run* run) const {
+
+    std::stringstream strRunID;
+    strRunID << run->GetRunID();
+
+    // Create full path by combining output directory and filename
+    G4String base = outputDirectory;
+    if (!base.empty() && base.back() != '/') {
+        base += '/';
+    }
+    return base + "output" + strRunID.str();
 }
 
 void MyRunAction::BeginOfRunAction(const G4Run* run){
 
-    G4AnalysisManager *man = G4AnalysisManager::Instance();
+    if (IsMaster()) {
+        fSetupTimer.Stop();
+        fSetupSeconds = fSetupTimer.GetRealElapsed();
+        fTimer.Start();
+    } else {
+        // GeometryDirectlyUpdated() only reaches the master: take the
+        // placements moved there since this thread copied them
+        MyDetectorConstruction::ApplyMoves();
+    }
 
-    G4int runID = run->GetRunID();
+    // The physics tables have just been built for this run
+    if (IsMaster()) MyPhysicsCache::Instance()->StoreIfPending();
 
-    std::stringstream strRunID;
-    strRunID << runID;
+    if (IsMaster() && run->GetRunID() == 0) {
+        const MyPhysicsList *physicsList = myPhysicsList();
+        if (physicsList) {
+            fInitSeconds = physicsList->GetInitSeconds();
+            G4cout << "[MyRunAction] Physics profile '" << physicsList->GetProfile() << "': initialised in "
+                   << fInitSeconds << " s (tables included), peak memory "
+                   << peakMemoryMB() << " MB" << G4endl;
+        }
+    }
 
-    // Create full path by combining output directory and filename
-    G4String filename = outputDirectory;
-    if (!filename.empty() && filename.back() != '/') {
-        filename += '/';
+    // Process codes used by the hit rows; the master writes the side table
+    MyProcessDictionary::Instance()->Build();
+    if (IsMaster()) MyProcessDictionary::Instance()->Write(RunFileBase(run) + "_processes.csv");
+
+    MyHitWriter::Instance()->SetWriteSteps(fWriteSteps);
+    MyHitWriter::Instance()->SetAsync(fAsyncOutput);
+    MyHitWriter::Instance()->SetPrimaryLog(MyHitWriter::ParsePrimaryLog(fPrimaryLog));
+
+    MyVoxelScorer *voxels = MyVoxelScorer::Instance();
+    voxels->SetActive(fVoxelActive);
+    voxels->SetGrid(static_cast<G4int>(fVoxelGrid.x()),
+                    static_cast<G4int>(fVoxelGrid.y()),
+                    static_cast<G4int>(fVoxelGrid.z()));
+    MyStepProfiler::Instance()->SetActive(fProfileActive);
+
+    MyPhaseSpaceRecorder *recorder = MyPhaseSpaceRecorder::Instance();
+    recorder->SetActive(fPhaseSpaceRecord);
+    if (fPhaseSpaceRecord) recorder->Configure(fPhaseSpaceVolume);
+    MyHitWriter::Instance()->SetPhaseSpace(fPhaseSpaceRecord);
+    G4AccumulableManager::Instance()->Reset();
+
+    MyHistograms *histograms = MyHistograms::Instance();
+    histograms->SetActive(fHistActive);
+    histograms->Configure(fHistEdep, fHistKinetic, fHistDepth);
+
+    // May restore the voxel grids and the histograms, so after they are
+    // reset
+    MyCheckpoint *checkpoint = MyCheckpoint::Instance();
+    if (IsMaster()) {
+        checkpoint->SetInterval(fCheckpointEvery);
+        checkpoint->BeginOfRun(run, fOutputFormat == "phx" && !G4Threading::IsMultithreadedApplication());
     }
-    filename += "output" + strRunID.str() + ".csv";
-    
-    man->SetFileName(filename);
+
+    G4bool phx = (fOutputFormat == "phx");
+    // The master has no sensitive detector in MT mode; it only merges
+    if (phx && !(IsMaster() && G4Threading::IsMultithreadedApplication())) {
+        G4String suffix = "";
+        if (G4Threading::IsWorkerThread()) suffix = "_t" + std::to_string(G4Threading::G4GetThreadId());
+        MyHitWriter::Instance()->Open(RunFileBase(run), suffix, checkpoint->GetOutputOffsets());
+        if (IsMaster()) checkpoint->Start();
+    }
+    if (phx && !fHistActive) return;
+
+    // The CSV ntuples, and the histograms in either format
+    G4AnalysisManager *man = G4AnalysisManager::Instance();
+
+    man->SetActivation(true);
+    for (G4int table = 0; table < MyHitWriter::kNTables; ++table) man->SetNtupleActivation(table, !phx);
+    if (!phx) {
+        man->SetNtupleActivation(MyHitWriter::kHits, fWriteSteps);
+        man->SetNtupleActivation(MyHitWriter::kPrimaries, fPrimaryLog != "none");
+        man->SetNtupleActivation(MyHitWriter::kPhaseSpace, fPhaseSpaceRecord);
+    }
+    man->SetFileName(RunFileBase(run) + ".csv");
     man->OpenFile();
 
 }
 
-void MyRunAction::EndOfRunAction(const G4Run*){
+void MyRunAction::EndOfRunAction(const G4Run* run){
 
-    G4AnalysisManager *man = G4AnalysisManager::Instance();
-    man->Write();
-    man->CloseFile();
+    if (fOutputFormat == "phx") MyHitWriter::Instance()->Close();
+    if (fOutputFormat == "csv" || fHistActive) {
+        // Workers add their histograms to the master's here
+        G4AnalysisManager *man = G4AnalysisManager::Instance();
+        man->Write();
+        man->CloseFile();
+    }
+
+    // Workers add their grids to the master's; no-op on the master
+    G4AccumulableManager::Instance()->Merge();
+
+    if (!IsMaster()) return;
+
+    if (G4Threading::IsMultithreadedApplication()) MergeThreadOutputs(run);
+
+    if (fVoxelActive) MyVoxelScorer::Instance()->Write(RunFileBase(run) + "_Voxels.phx");
+    if (fProfileActive) MyStepProfiler::Instance()->Report(RunFileBase(run) + "_profile.csv", fProfileTop);
+    if (fPhaseSpaceRecord) WritePhaseSpaceInfo(run);
+    MyCheckpoint::Instance()->EndOfRun();
+
+    fTimer.Stop();
+    const MyPhysicsList *physicsList = myPhysicsList();
+    G4int    nEvents = run->GetNumberOfEvent();
+    G4double seconds = fTimer.GetRealElapsed();
+    G4cout << "[MyRunAction] Run " << run->GetRunID() << ": " << nEvents << " events in "
+           << seconds << " s (" << (seconds > 0. ? nEvents / seconds : 0.) << " events/s, "
+           << G4RunManager::GetRunManager()->GetNumberOfThreads() << " threads, physics profile '"
+           << (physicsList ? physicsList->GetProfile() : G4String("")) << "', peak memory " << peakMemoryMB() << " MB)" << G4endl;
+    // Per-profile figures, for comparing invocations with compare_runs.py
+    MyRunSummary *summary = MyRunSummary::Instance();
+    if (physicsList) summary->Set("profile", physicsList->GetProfile());
+    summary->Set("init_s", fInitSeconds);
+    summary->Set("setup_s", fSetupSeconds);
+    summary->Set("peak_rss_MB", peakMemoryMB());
+    summary->Set("threads", G4RunManager::GetRunManager()->GetNumberOfThreads());
+    summary->Report(RunFileBase(run) + "_summary.csv", seconds);
+
+    fSetupTimer.Start();
+}
 
+void MyRunAction::WritePhaseSpaceInfo(const G4Run* run) const {
+
+    // Source events without a particle through the surface have no rows:
+    // normalise replays by this count, not by the events in the table. A
+    // resumed run only ran the events after its checkpoint.
+    const MyPhaseSpaceRecorder *recorder = MyPhaseSpaceRecorder::Instance();
+    G4String path = RunFileBase(run) + "_PhaseSpace_info.csv";
+    std::ofstream fout(path);
+    if (!fout.is_open()) {
+        G4cout << "[MyRunAction] Could not open '" << path << "'" << G4endl;
+        return;
+    }
+    fout << "key,value\n"
+         << "sourceEvents," << MyCheckpoint::Instance()->GetFirstEvent() + run->GetNumberOfEvent() << "\n"
+         << "volume," << fPhaseSpaceVolume << "\n"
+         << "radius_mm," << recorder->GetRadius() / mm << "\n"
+         << "halfZ_mm," << recorder->GetHalfZ() / mm << "\n"
+         << "centreZ_mm," << recorder->GetCentre().z() / mm << "\n";
+}
+
+void MyRunAction::MergeThreadOutputs(const G4Run* run) const {
+
+    G4int nThreads = G4RunManager::GetRunManager()->GetNumberOfThreads();
+
+    for (G4int table = 0; table < MyHitWriter::kNTables; ++table) {
+        if (table == MyHitWriter::kHits && !fWriteSteps) continue;
+        if (table == MyHitWriter::kPrimaries && fPrimaryLog == "none") continue;
+        if (table == MyHitWriter::kPhaseSpace && !fPhaseSpaceRecord) continue;
+
+        G4String tableName = MyHitWriter::TableName(table);
+        G4String tableBase = RunFileBase(run) + (fOutputFormat == "phx" ? "_" : "_nt_") + tableName;
+        G4String tableExt  = (fOutputFormat == "phx") ? ".phx" : ".csv";
+
+        std::vector<G4String> parts;
+        for (G4int i = 0; i < nThreads; ++i) {
+            parts.push_back(tableBase + "_t" + std::to_string(i) + tableExt);
+        }
+
+        if (fOutputFormat == "phx") {
+            std::vector<std::string> phxParts(parts.begin(), parts.end());
+            // The thread files stay for a manual phoenix_merge unless merged
+            try {
+                if (!mergeColumnFiles(tableBase + tableExt, phxParts)) {
+                    G4cout << "[MyRunAction] No thread files to merge into '" << tableBase << tableExt << "'" << G4endl;
+                    continue;
+                }
+            } catch (const std::exception& e) {
+                G4cerr << "[MyRunAction] Merge into '" << tableBase << tableExt << "' failed: " << e.what() << G4endl;
+                continue;
+            }
+            for (const auto &part : phxParts) std::remove(part.c_str());
+        } else {
+            MergeTextFiles(tableBase + tableExt, parts, true, true);
+        }
+    }
 }
@@ -1,52 +1,51 @@
 #include "MySensitiveDetector.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4SDManager.hh"
+#include "MyHistograms.hh"
+#include "MyVoxelScorer.hh"
 
 MySensitiveDetector::MySensitiveDetector(G4String name) 
-    : G4VSensitiveDetector(name){
+    : G4VSensitiveDetector(name), fEventID(-1), fHCID(-1), fHitsCollection(nullptr){
+    collectionName.insert("CrystalHits");
 }
 
 MySensitiveDetector::~MySensitiveDetector(){
 }
 
+void MySensitiveDetector::Initialize(G4HCofThisEvent* hce){
+    // No run manager (or event) when driven by phoenix_bench
+    G4RunManager *runManager = G4RunManager::GetRunManager();
+    const G4Event *event = runManager ? runManager->GetCurrentEvent() : nullptr;
+    fEventID = event ? event->GetEventID() : -1;
+
+    fHitsCollection = new MyCrystalHitsCollection(SensitiveDetectorName, collectionName[0]);
+    if (fHCID < 0) fHCID = G4SDManager::GetSDMpointer()->GetCollectionID(fHitsCollection);
+    hce->AddHitsCollection(fHCID, fHitsCollection);
+
+    fHitIndex.clear();
+}
+
 G4bool MySensitiveDetector::ProcessHits(G4Step *aStep, 
                                         G4TouchableHistory *R0hist){ 
 
+    // Nothing in here allocates per step: processes are reported as
+    // interned codes and a hit is only created for a new (track, copy)
     G4Track     *track         = aStep->GetTrack();
     G4StepPoint *preStepPoint  = aStep->GetPreStepPoint();
-    G4StepPoint *postStepPoint = aStep->GetPostStepPoint();
-
-    const G4VProcess *preProc = preStepPoint->GetProcessDefinedStep(); 
-    G4String preProcName = "NA";
-    if (preProc) preProcName = preProc->GetProcessName();
-
-    const G4VProcess *postProc = postStepPoint->GetProcessDefinedStep(); 
-    G4String postProcName = "NA";
-    if (postProc) postProcName = postProc->GetProcessName();
 
     G4bool isEntry = (preStepPoint->GetStepStatus()==fGeomBoundary);
 
     G4int copyNo = preStepPoint->GetTouchableHandle()->GetCopyNumber();
     G4int trackID  = track->GetTrackID();
-    G4int parentID = track->GetParentID();
 
     // Kill track at interface with LiF cube if thermal neutron
     // track->SetTrackStatus(fStopAndKill);
 
-    G4ThreeVector prePos = preStepPoint->GetPosition();
-    G4ThreeVector postPos = postStepPoint->GetPosition();
-    //G4ThreeVector pos = 0.5 * (prePos + postPos);
-
     G4double edep = aStep->GetTotalEnergyDeposit();
     //if(edep==0) return false;
 
     G4double kinetic = preStepPoint->GetKineticEnergy();
 
-    G4VPhysicalVolume* volume = preStepPoint->GetTouchableHandle()->GetVolume();
-    G4String volName = volume->GetName();
-
-    G4int evt = G4RunManager::GetRunManager()->GetCurrentEvent()->GetEventID();
-
-    G4AnalysisManager *man = G4AnalysisManager::Instance();
-
     G4int pdgID = track->GetDefinition()->GetPDGEncoding();
 
     //if((pdgID==2112) & (isEntry==1) & (kinetic < 0.000001)){
@@ -55,23 +54,39 @@ G4bool MySensitiveDetector::ProcessHits(G4Step *aStep,
     //    postProcName = "nCusCap";
     //}
 
-    man->FillNtupleIColumn( 0, evt);
-    man->FillNtupleIColumn( 1, isEntry);
-    man->FillNtupleSColumn( 2, preProcName);
-    man->FillNtupleSColumn( 3, postProcName);
-    man->FillNtupleIColumn( 4, trackID);
-    man->FillNtupleIColumn( 5, parentID);
-    man->FillNtupleIColumn( 6, pdgID);
-    man->FillNtupleDColumn( 7, kinetic);
-    man->FillNtupleDColumn( 8, edep);
-    man->FillNtupleDColumn( 9, prePos[0]);
-    man->FillNtupleDColumn(10, prePos[1]);
-    man->FillNtupleDColumn(11, prePos[2]);
-    man->FillNtupleDColumn(12, postPos[0]);
-    man->FillNtupleDColumn(13, postPos[1]);
-    man->FillNtupleDColumn(14, postPos[2]);
-    man->FillNtupleIColumn(15, copyNo);
-    man->AddNtupleRow(0);
+    MyProcessDictionary *procDict = MyProcessDictionary::Instance();
+
+    G4long key = (static_cast<G4long>(trackID) << 32) | static_cast<std::uint32_t>(copyNo);
+    auto it = fHitIndex.find(key);
+    MyCrystalHit *hit;
+    if (it != fHitIndex.end()) {
+        hit = (*fHitsCollection)[it->second];
+    } else {
+        hit = new MyCrystalHit(trackID, track->GetParentID(), pdgID, copyNo,
+                               procDict->Code(track->GetCreatorProcess()), isEntry, kinetic,
+                               track->GetWeight());
+        fHitIndex.emplace(key, fHitsCollection->insert(hit) - 1);
+    }
+    hit->AddStep(edep);
+
+    MyVoxelScorer *voxels = MyVoxelScorer::Instance();
+    if (voxels->IsActive()) voxels->Score(aStep, copyNo);
+
+    MyHistograms *histograms = MyHistograms::Instance();
+    if (histograms->IsActive()) histograms->FillStep(aStep);
+
+    // Debug mode: one row per step, as before the hits collection
+    MyHitWriter *writer = MyHitWriter::Instance();
+    if (writer->GetWriteSteps()) {
+        G4StepPoint *postStepPoint = aStep->GetPostStepPoint();
+        G4int preProc  = procDict->Code(preStepPoint ->GetProcessDefinedStep());
+        G4int postProc = procDict->Code(postStepPoint->GetProcessDefinedStep());
+
+        writer->FillStep(fEventID, isEntry, preProc, postProc,
+                         trackID, track->GetParentID(), pdgID, kinetic, edep,
+                         preStepPoint->GetPosition(), postStepPoint->GetPosition(), copyNo,
+                         track->GetWeight());
+    }
 
     return true;
-}
\ No newline at end of file
+}
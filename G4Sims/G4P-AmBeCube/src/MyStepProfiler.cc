@@ -0,0 +1,169 @@
+#include "MyStepProfiler.hh"
+
+#include "G4LogicalVolume.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4VProcess.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <vector>
+
+MyStepProfiler* MyStepProfiler::Instance() {
+    static G4ThreadLocal MyStepProfiler* instance = nullptr;
+    if (!instance) instance = new MyStepProfiler();
+    return instance;
+}
+
+MyStepProfiler::MyStepProfiler()
+    : G4VAccumulable("StepProfiler"), fActive(false),
+      fLastKey{nullptr, nullptr, nullptr}, fLastEntry(nullptr) {
+}
+
+MyStepProfiler::Entry& MyStepProfiler::Find(const Key& key) {
+    if (fLastEntry && key == fLastKey) return *fLastEntry;
+    fLastKey   = key;
+    fLastEntry = &fEntries[key];
+    return *fLastEntry;
+}
+
+void MyStepProfiler::StartTrack(const G4Track* track) {
+
+    const G4VPhysicalVolume *volume = track->GetVolume();
+    Key key{volume ? volume->GetLogicalVolume() : nullptr,
+            track->GetDefinition(), track->GetCreatorProcess()};
+    Find(key).nTracks++;
+
+    fLastTime = Clock::now();
+}
+
+void MyStepProfiler::Step(const G4Step* step) {
+
+    Clock::time_point now = Clock::now();
+
+    const G4StepPoint *pre = step->GetPreStepPoint();
+    Key key{pre->GetPhysicalVolume()->GetLogicalVolume(),
+            step->GetTrack()->GetDefinition(),
+            step->GetPostStepPoint()->GetProcessDefinedStep()};
+    Entry &entry = Find(key);
+    entry.nSteps++;
+    entry.seconds += std::chrono::duration<G4double>(now - fLastTime).count();
+
+    fLastTime = now;
+}
+
+void MyStepProfiler::FoldByName(std::map<NamedKey, Entry>& named) const {
+
+    for (const auto &kv : fEntries) {
+        const Key &key = kv.first;
+        NamedKey name(key.volume   ? key.volume->GetName()          : G4String("NA"),
+                      key.particle ? key.particle->GetParticleName() : G4String("NA"),
+                      key.process  ? key.process->GetProcessName()   : G4String("primary"));
+        Entry &entry = named[name];
+        entry.nSteps  += kv.second.nSteps;
+        entry.nTracks += kv.second.nTracks;
+        entry.seconds += kv.second.seconds;
+    }
+}
+
+void MyStepProfiler::Merge(const G4VAccumulable& other) {
+    // Processes are per thread, so workers are merged by name
+    static_cast<const MyStepProfiler&>(other).FoldByName(fMerged);
+}
+
+void MyStepProfiler::Reset() {
+    fEntries.clear();
+    fMerged.clear();
+    fLastEntry = nullptr;
+}
+
+void MyStepProfiler::Save(std::ostream& out) const {
+
+    std::map<NamedKey, Entry> named = fMerged;
+    FoldByName(named);
+    out << std::setprecision(std::numeric_limits<G4double>::max_digits10);
+    for (const auto &kv : named) {
+        out << std::get<0>(kv.first) << "," << std::get<1>(kv.first) << "," << std::get<2>(kv.first) << ","
+            << kv.second.nSteps << "," << kv.second.nTracks << "," << kv.second.seconds << "\n";
+    }
+}
+
+G4bool MyStepProfiler::Load(std::istream& in) {
+
+    std::map<NamedKey, Entry> named;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string volume, particle, process, steps, tracks, seconds;
+        if (!std::getline(fields, volume, ',') || !std::getline(fields, particle, ',') ||
+            !std::getline(fields, process, ',') || !std::getline(fields, steps, ',') ||
+            !std::getline(fields, tracks, ',') || !std::getline(fields, seconds))
+            return false;
+        Entry &entry = named[NamedKey(volume, particle, process)];
+        entry.nSteps  = std::stol(steps);
+        entry.nTracks = std::stol(tracks);
+        entry.seconds = std::stod(seconds);
+    }
+    fMerged = std::move(named);
+    return true;
+}
+
+void MyStepProfiler::Report(const G4String& csvPath, G4int nTop) {
+
+    // In sequential mode the master did the stepping itself
+    FoldByName(fMerged);
+    fEntries.clear();
+    fLastEntry = nullptr;
+
+    std::vector<std::pair<NamedKey, Entry>> rows(fMerged.begin(), fMerged.end());
+    std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+        return a.second.seconds > b.second.seconds;
+    });
+
+    G4long   totalSteps   = 0;
+    G4double totalSeconds = 0.;
+    for (const auto &row : rows) {
+        totalSteps   += row.second.nSteps;
+        totalSeconds += row.second.seconds;
+    }
+
+    std::ofstream fout(csvPath);
+    if (fout.is_open()) {
+        fout << "volume,particle,process,steps,tracks,seconds,ns_per_step\n";
+        for (const auto &row : rows) {
+            const Entry &e = row.second;
+            fout << std::get<0>(row.first) << "," << std::get<1>(row.first) << ","
+                 << std::get<2>(row.first) << "," << e.nSteps << "," << e.nTracks << ","
+                 << e.seconds << "," << (e.nSteps > 0 ? 1e9 * e.seconds / e.nSteps : 0.) << "\n";
+        }
+    }
+
+    G4cout << "[MyStepProfiler] " << totalSteps << " steps, " << totalSeconds
+           << " s of tracking (summed over threads); top " << nTop
+           << " of " << rows.size() << " (volume, particle, process), all in " << csvPath << G4endl;
+    G4cout << std::setw(24) << std::left << "volume" << std::setw(14) << "particle"
+           << std::setw(22) << "process" << std::right << std::setw(12) << "steps"
+           << std::setw(10) << "tracks" << std::setw(10) << "s" << std::setw(8) << "%"
+           << std::setw(10) << "ns/step" << G4endl;
+
+    G4int n = std::min<G4int>(nTop, static_cast<G4int>(rows.size()));
+    for (G4int i = 0; i < n; ++i) {
+        const Entry &e = rows[i].second;
+        G4cout << std::setw(24) << std::left << std::get<0>(rows[i].first)
+               << std::setw(14) << std::get<1>(rows[i].first)
+               << std::setw(22) << std::get<2>(rows[i].first) << std::right
+               << std::setw(12) << e.nSteps << std::setw(10) << e.nTracks
+               << std::setw(10) << std::setprecision(3) << e.seconds
+               << std::setw(8)  << std::setprecision(3) << (totalSeconds > 0. ? 100. * e.seconds / totalSeconds : 0.)
+               << std::setw(10) << std::setprecision(4) << (e.nSteps > 0 ? 1e9 * e.seconds / e.nSteps : 0.)
+               << G4endl;
+    }
+    G4cout << std::setprecision(6);
+}
@@ -3,6 +3,8 @@
 #include "G4Step.hh"
 #include "G4Track.hh"
 #include "G4SystemOfUnits.hh"
+#include "MyPhaseSpaceRecorder.hh"
+#include "MyStepProfiler.hh"
 
 MySteppingAction::MySteppingAction() {
 }
@@ -10,5 +12,10 @@ MySteppingAction::MySteppingAction() {
 MySteppingAction::~MySteppingAction() {
 }
 
-void MySteppingAction::UserSteppingAction(const G4Step*) {
+void MySteppingAction::UserSteppingAction(const G4Step* step) {
+    MyStepProfiler *profiler = MyStepProfiler::Instance();
+    if (profiler->IsActive()) profiler->Step(step);
+
+    MyPhaseSpaceRecorder *recorder = MyPhaseSpaceRecorder::Instance();
+    if (recorder->IsActive()) recorder->Step(step);
 }
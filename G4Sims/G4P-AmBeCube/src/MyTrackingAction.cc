@@ -1,6 +1,7 @@
 #include "MyTrackingAction.hh"
 
 #include "G4Track.hh"
+#include "MyStepProfiler.hh"
 
 MyTrackingAction::MyTrackingAction() {
 };
@@ -8,7 +9,9 @@ MyTrackingAction::MyTrackingAction() {
 MyTrackingAction::~MyTrackingAction() {
 };
 
-void MyTrackingAction::PreUserTrackingAction(const G4Track*) {
+void MyTrackingAction::PreUserTrackingAction(const G4Track* track) {
+    MyStepProfiler *profiler = MyStepProfiler::Instance();
+    if (profiler->IsActive()) profiler->StartTrack(track);
 };
 
 void MyTrackingAction::PostUserTrackingAction(const G4Track*) {
@@ -0,0 +1,122 @@
+#include "SpectrumLibrary.hh"
+
+#include "G4AutoLock.hh"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close
+
+namespace {
+
+G4Mutex spectrumMutex = G4MUTEX_INITIALIZER;
+
+// File spectra, by path, for the lifetime of the process: generators hold
+// views into them
+std::map<std::string, std::unique_ptr<SpectrumSampler>>& loadedSpectra() {
+    static std::map<std::string, std::unique_ptr<SpectrumSampler>> loaded;
+    return loaded;
+}
+
+bool endsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() &&
+           s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::unique_ptr<SpectrumSampler> readCsv(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot open " + path);
+
+    std::vector<double> E, w;
+    std::string line;
+    for (size_t lineNo = 1; std::getline(in, line); ++lineNo) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') continue;
+
+        const char* p = line.c_str() + start;
+        char* end = nullptr;
+        double e = std::strtod(p, &end);
+        bool ok = end != p;
+        if (ok) {
+            while (*end == ' ' || *end == '\t' || *end == ',' || *end == ';') ++end;
+            p = end;
+            double x = std::strtod(p, &end);
+            ok = end != p;
+            if (ok) { E.push_back(e); w.push_back(x); }
+        }
+        // A header is only allowed before the first row
+        if (!ok && !E.empty())
+            throw std::runtime_error(path + ":" + std::to_string(lineNo) + ": expected 'E_MeV,weight'");
+    }
+    return std::make_unique<SpectrumSampler>(E, w);
+}
+
+std::unique_ptr<SpectrumSampler> readBinary(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("cannot open " + path);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < 16) {
+        ::close(fd);
+        throw std::runtime_error(path + ": not a PHXS spectrum");
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) throw std::runtime_error("cannot map " + path);
+
+    // The tables are built straight from the mapped nodes; only the built
+    // tables stay in memory afterwards
+    std::unique_ptr<SpectrumSampler> sampler;
+    std::string error;
+    const char* bytes = static_cast<const char*>(map);
+    std::uint32_t version = 0;
+    std::uint64_t n = 0;
+    std::memcpy(&version, bytes + 4, 4);
+    std::memcpy(&n, bytes + 8, 8);
+    if (std::memcmp(bytes, "PHXS", 4) != 0 || version != 1)
+        error = path + ": not a PHXS version 1 spectrum";
+    else if (n > (size - 16) / 16 || size != 16 + 16 * n)
+        error = path + ": size does not match " + std::to_string(n) + " nodes";
+    else {
+        const double* E = reinterpret_cast<const double*>(bytes + 16);
+        try {
+            sampler = std::make_unique<SpectrumSampler>(E, E + n, static_cast<size_t>(n));
+        } catch (const std::exception& e) {
+            error = path + ": " + e.what();
+        }
+    }
+    ::munmap(map, size);
+
+    if (!sampler) throw std::runtime_error(error);
+    return sampler;
+}
+
+}
+
+std::vector<std::string> SpectrumLibrary::BuiltinNames() {
+    return {"AmBe", "Cf252"};
+}
+
+SpectrumView SpectrumLibrary::Get(const std::string& nameOrPath) {
+    if (nameOrPath == "AmBe")  return Spectra::kAmBe.view();
+    if (nameOrPath == "Cf252") return Spectra::kCf252.view();
+
+    // Every worker asks for the file when the command is broadcast; the first
+    // one reads it
+    G4AutoLock lock(&spectrumMutex);
+    auto& loaded = loadedSpectra();
+    auto it = loaded.find(nameOrPath);
+    if (it == loaded.end()) {
+        auto sampler = endsWith(nameOrPath, ".csv") ? readCsv(nameOrPath) : readBinary(nameOrPath);
+        it = loaded.emplace(nameOrPath, std::move(sampler)).first;
+    }
+    return it->second->view();
+}
@@ -7,14 +7,14 @@
 
 class MyActionInitialization : public G4VUserActionInitialization{
     public:
-        MyActionInitialization();
+        MyActionInitialization(const G4String& outputPath = "./");
         ~MyActionInitialization();
 
+        virtual void BuildForMaster() const;
         virtual void Build() const;
-        MyRunAction* GetUserRunAction() const { return fRunAction; }
 
     private:
-        MyRunAction* fRunAction;
+        G4String fOutputPath;
 };
 
 #endif
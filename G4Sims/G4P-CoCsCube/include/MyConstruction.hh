@@ -14,6 +14,12 @@
 #include "G4Colour.hh"
 #include "G4VisAttributes.hh"
 
+#include "G4SDManager.hh"
+
+#include <map>
+#include <utility>
+#include <vector>
+
 #include "MyDetector.hh"
 
 class MyDetectorConstruction : public G4VUserDetectorConstruction{
@@ -23,6 +29,18 @@ class MyDetectorConstruction : public G4VUserDetectorConstruction{
 
         virtual G4VPhysicalVolume* Construct();
 
+        // Sweep cubes: copy number = side*10000 + distance, both in units of
+        // 0.1 mm (e.g. 250150 is a 2.5 mm cube at 15 mm from the axis)
+        static G4int CubeCopyNumber(G4double distance, G4double side);
+
+        // At most kMaxSweepCubes, one per quarter turn around the source.
+        // Like CubeDistance, changes after /run/initialize need
+        // /run/reinitializeGeometry.
+        void AddCube(G4double distance, G4double side);
+        void ClearCubes();
+
+        static constexpr std::size_t kMaxSweepCubes = 4;
+
     private:
         // World  := Mother volume
         // Holder := Circular plastic crystal holder
@@ -33,8 +51,23 @@ class MyDetectorConstruction : public G4VUserDetectorConstruction{
         // Messenger variables
         G4double CubeDistance, CubeSide;
 
+        // Extra (distance, side) pairs in cm, all placed in the same geometry;
+        // when empty the single CubeDistance/CubeSide cube has copy number 0
+        std::vector<std::pair<G4double, G4double>> fSweepCubes;
+
         G4LogicalVolume *logicCube;
+        // One sensitive logical volume per cube side
+        std::map<G4double, G4LogicalVolume*> fCubeLogicals;
         virtual void ConstructSDandField();
+        void ConstructCubes(G4double holderHeight);
+        void WarnIfBuilt() const;
+
+        // Production-cut regions (cuts are set by MyPhysicsList):
+        //   Crystals     - the LiF cubes, where dose is scored
+        //   SourceShield - the Pb blocks and source cylinder
+        //   Structure    - the concrete floor
+        // The holder and tube, next to the cubes, keep the default cut
+        void DefineRegions();
 
         G4Box *solidWorld, *solidFloor, *solidCube;
         G4Box *solidBlockBottom; 
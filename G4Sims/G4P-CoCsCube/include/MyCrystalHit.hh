@@ -0,0 +1,57 @@
+#ifndef MY_CRYSTAL_HIT_HH
+#define MY_CRYSTAL_HIT_HH
+
+#include "G4VHit.hh"
+#include "G4THitsCollection.hh"
+#include "G4Allocator.hh"
+#include "globals.hh"
+
+// One track inside one crystal copy during one event: the deposits of all
+// its steps there are summed by MySensitiveDetector.
+class MyCrystalHit : public G4VHit {
+    public:
+        MyCrystalHit(G4int trackID, G4int parentID, G4int pdg, G4int copyNo,
+                     G4int creator, G4bool entered, G4double kinetic);
+        ~MyCrystalHit();
+
+        inline void* operator new(size_t);
+        inline void  operator delete(void*);
+
+        void AddStep(G4double edep) { fEdep += edep; ++fNSteps; }
+
+        G4int    GetTrackID()  const { return fTrackID; }
+        G4int    GetParentID() const { return fParentID; }
+        G4int    GetPDG()      const { return fPDG; }
+        G4int    GetCopyNo()   const { return fCopyNo; }
+        G4int    GetCreator()  const { return fCreator; }
+        G4bool   GetEntered()  const { return fEntered; }
+        G4double GetKinetic()  const { return fKinetic; }
+        G4double GetEdep()     const { return fEdep; }
+        G4int    GetNSteps()   const { return fNSteps; }
+
+    private:
+        G4int    fTrackID;
+        G4int    fParentID;
+        G4int    fPDG;
+        G4int    fCopyNo;
+        G4int    fCreator;  // MyProcessDictionary code of the creator process
+        G4bool   fEntered;  // first step started on the crystal boundary
+        G4double fKinetic;  // kinetic energy at the first step in the crystal
+        G4double fEdep;
+        G4int    fNSteps;
+};
+
+using MyCrystalHitsCollection = G4THitsCollection<MyCrystalHit>;
+
+extern G4ThreadLocal G4Allocator<MyCrystalHit>* MyCrystalHitAllocator;
+
+inline void* MyCrystalHit::operator new(size_t) {
+    if (!MyCrystalHitAllocator) MyCrystalHitAllocator = new G4Allocator<MyCrystalHit>;
+    return (void*) MyCrystalHitAllocator->MallocSingle();
+}
+
+inline void MyCrystalHit::operator delete(void* hit) {
+    MyCrystalHitAllocator->FreeSingle((MyCrystalHit*) hit);
+}
+
+#endif
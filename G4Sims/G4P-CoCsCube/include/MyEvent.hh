@@ -1 +1,37 @@
+#ifndef MY_EVENT_HH
+#define MY_EVENT_HH
 
+#include <vector>
+
+#include "G4UserEventAction.hh"
+#include "globals.hh"
+
+// Reduces the crystal hits collection of each event to the Tracks,
+// Deposits and Events tables of MyHitWriter, and adds the crystal
+// deposits to MyRunSummary.
+class MyEventAction : public G4UserEventAction {
+    public:
+        MyEventAction();
+        ~MyEventAction();
+
+        virtual void BeginOfEventAction(const G4Event *anEvent);
+        virtual void EndOfEventAction(const G4Event *anEvent);
+
+    private:
+        void Record(const G4Event *anEvent);
+
+        G4int fHCID;
+
+        // Per-event sums for each (copy, particle); reused between events
+        struct Deposit {
+            G4int    copyNo;
+            G4int    pdg;
+            G4double edep;
+            G4int    nTracks;
+        };
+        std::vector<Deposit> fDeposits;
+        std::vector<G4int>   fCopies;
+};
+
+
+#endif
@@ -6,6 +6,7 @@
 #include "G4GenericMessenger.hh"
 
 class G4Event;
+class G4ParticleDefinition;
 
 class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction {
 public:
@@ -14,8 +15,15 @@ public:
 
     virtual void GeneratePrimaries(G4Event*);
 
+    void SetSourceHeight(G4double height);
+
 private:
+    // Ion lookup and gun setup, done once per thread on the first event
+    // (the ion table is only usable after physics initialisation)
+    void DefineSource();
+
     G4ParticleGun* fParticleGun;
+    G4ParticleDefinition* fSourceIon;
 
     G4double SourceHeight;
     G4GenericMessenger *fMessengerSource;
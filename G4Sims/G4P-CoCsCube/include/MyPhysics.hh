@@ -1,13 +1,35 @@
 #ifndef MY_PHYSICS_HH
 #define MY_PHYSICS_HH
 
+#include <map>
+
 #include "G4VModularPhysicsList.hh"
 #include "G4EmStandardPhysics.hh"
+#include "G4GenericMessenger.hh"
 
 class MyPhysicsList : public G4VModularPhysicsList{
     public:
         MyPhysicsList();
         ~MyPhysicsList();
+
+        // Default cuts, the region cuts, then the warm-start cache lookup
+        // (MyPhysicsCache)
+        virtual void SetCuts();
+
+        // Production cut of a region of MyDetectorConstruction (Crystals,
+        // SourceShield, Structure)
+        void SetRegionCut(const G4String& region, G4double cut);
+
+    private:
+        // Range cut per region; regions not listed use the default cut
+        std::map<G4String, G4double> fRegionCuts;
+        G4GenericMessenger *fMessengerCuts;
+
+        void SetCrystalsCut(G4double cut)     { SetRegionCut("Crystals", cut); }
+        void SetSourceShieldCut(G4double cut) { SetRegionCut("SourceShield", cut); }
+        void SetStructureCut(G4double cut)    { SetRegionCut("Structure", cut); }
+
+        void ApplyRegionCuts() const;
 };
 
 #endif
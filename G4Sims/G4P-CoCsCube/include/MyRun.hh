@@ -3,6 +3,9 @@
 
 #include "G4UserRunAction.hh"
 #include "G4Run.hh"
+#include "G4Timer.hh"
+#include "G4GenericMessenger.hh"
+#include "G4ThreeVector.hh"
 #include <string>
 
 class MyRunAction : public G4UserRunAction{
@@ -15,10 +18,30 @@ class MyRunAction : public G4UserRunAction{
         
     private:
         G4String fOutputDirectory;
+        G4Timer  fTimer;
+
+        // Output format: "phx" (binary columnar) or "csv" (G4 ntuples)
+        G4String fOutputFormat;
+        // Also write one raw row per step (debug)
+        G4bool   fWriteSteps;
+        // PHXC rows go through a writer thread (AsyncColumnWriter)
+        G4bool   fAsyncOutput;
+        G4GenericMessenger* fMessengerOutput;
+
+        // Voxelised deposit map over the cube (MyVoxelScorer)
+        G4bool        fVoxelActive;
+        G4ThreeVector fVoxelGrid;
+        G4GenericMessenger* fMessengerVoxel;
+
+        // <fOutputDirectory>/run_<runID>
+        G4String RunFileBase(const G4Run*) const;
 
     virtual void BeginOfRunAction(const G4Run*);
     virtual void EndOfRunAction(const G4Run*);
 
+    // Master only: produce run_<id>.phx/.csv from the sequential or per-thread outputs
+    void FinaliseOutput(const G4Run*) const;
+
 };
 
 #endif
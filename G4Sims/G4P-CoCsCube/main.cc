@@ -7,8 +7,11 @@
 // =========================================================================
 
 #include <iostream>
+#include <cstdlib>
+#include <vector>
 
 #include "G4RunManager.hh"
+#include "G4RunManagerFactory.hh"
 #include "G4UIExecutive.hh"
 #include "G4UImanager.hh"
 #include "G4VisExecutive.hh"
@@ -17,35 +20,63 @@
 #include "MyAction.hh"
 #include "MyConstruction.hh"
 #include "MyPhysics.hh"
+#include "MyPhysicsCache.hh"
 
 #include <fstream>
 
+// Usage: CoCsCubeEXE [macro] [outputDir] [-m serial|mt|tasking] [-t nThreads] [-c cacheDir]
 int main(int argc, char **argv){
-   
-    G4RunManager* runManager = new G4RunManager();
+
+    // Split options from the positional (macro, output directory) arguments.
+    // Default lets Geant4 pick the task-based manager when built with MT.
+    G4RunManagerType runType  = G4RunManagerType::Default;
+    G4int            nThreads = 0;
+    std::vector<G4String> args;
+    for (G4int i = 1; i < argc; ++i) {
+        G4String arg = argv[i];
+        if ((arg == "-m" || arg == "--mode") && i + 1 < argc) {
+            G4String mode = argv[++i];
+            if      (mode == "serial")  runType = G4RunManagerType::Serial;
+            else if (mode == "mt")      runType = G4RunManagerType::MT;
+            else if (mode == "tasking") runType = G4RunManagerType::Tasking;
+            else {
+                G4cerr << "Unknown run mode '" << mode << "' (serial|mt|tasking)" << G4endl;
+                return 1;
+            }
+        }
+        else if ((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+            nThreads = std::atoi(argv[++i]);
+        }
+        else if ((arg == "-c" || arg == "--cache") && i + 1 < argc) {
+            // Warm start: reuse physics tables stored by an earlier invocation
+            MyPhysicsCache::Instance()->SetDirectory(argv[++i]);
+        }
+        else {
+            args.push_back(arg);
+        }
+    }
+
+    auto runManager = G4RunManagerFactory::CreateRunManager(runType);
+    if (nThreads > 0) runManager->SetNumberOfThreads(nThreads);
 
     runManager->SetUserInitialization(new MyDetectorConstruction()); 
     runManager->SetUserInitialization(new MyPhysicsList()); 
 
     // Get output directory from command line if provided
     G4String outputDir = "./";
-    if (argc > 2) {
-        outputDir = argv[2];
+    if (args.size() > 1) {
+        outputDir = args[1];
     }
 
-    auto actionInit = new MyActionInitialization();
-    auto runAction = dynamic_cast<MyRunAction*>(actionInit->GetUserRunAction());
-    if (runAction) {
-        runAction->SetOutputDirectory(outputDir);
-    }
-    
-    runManager->SetUserInitialization(actionInit);
+    // The output directory is handed to every run action (master and
+    // workers) when the actions are built
+    runManager->SetUserInitialization(new MyActionInitialization(outputDir));
 
     //runManager->Initialize();
 
     // Initialize visualisation only if no macro is passed
     G4UIExecutive* ui = 0;
-    if(argc==1){
+    if(args.empty()){
        ui = new G4UIExecutive(argc, argv);
     }
 
@@ -56,11 +87,12 @@ int main(int argc, char **argv){
 
     if(ui){
         uiManager->ApplyCommand("/control/execute macros/vis.mac");
-        ui->SessionStart();    
+        ui->SessionStart();
+        delete ui;
     }
     else{
         G4String command = "/control/execute ";
-        G4String filename = argv[1];
+        G4String filename = args[0];
 
         // If the file as given doesn't exist, try the local macros/ directory
         std::ifstream f(filename.c_str());
@@ -75,6 +107,9 @@ int main(int argc, char **argv){
 
         uiManager->ApplyCommand(command + filename);
     }
+
+    delete visManager;
+    delete runManager;
     
     return 0;
 } 
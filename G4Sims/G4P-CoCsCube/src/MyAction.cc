@@ -1,16 +1,27 @@
 #include "MyAction.hh"
 #include "MyGenerator.hh"
-#include "MyTracking.hh"
+#include "MyStackingAction.hh"
+#include "MyEvent.hh"
 
-MyActionInitialization::MyActionInitialization() : fRunAction(new MyRunAction()) {
+MyActionInitialization::MyActionInitialization(const G4String& outputPath) : fOutputPath(outputPath) {
 }
 
 MyActionInitialization::~MyActionInitialization(){
-    delete fRunAction;
 }
 
+void MyActionInitialization::BuildForMaster() const{
+    MyRunAction *runAction = new MyRunAction();
+    runAction->SetOutputDirectory(fOutputPath);
+    SetUserAction(runAction);
+};
+
 void MyActionInitialization::Build() const{
     SetUserAction(new PrimaryGeneratorAction);
-    SetUserAction(fRunAction);
-    SetUserAction(new MyTrackingAction());
+
+    MyRunAction *runAction = new MyRunAction();
+    runAction->SetOutputDirectory(fOutputPath);
+    SetUserAction(runAction);
+
+    SetUserAction(new MyEventAction());
+    SetUserAction(new MyStackingAction());
 };
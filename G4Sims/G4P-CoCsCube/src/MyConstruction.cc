@@ -1,5 +1,12 @@
 #include "MyConstruction.hh"
 
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4StateManager.hh"
+#include "G4Transform3D.hh"
+
+#include <cmath>
+
 MyDetectorConstruction::MyDetectorConstruction(){
 
     fMessengerCube = new G4GenericMessenger(this,
@@ -14,6 +21,16 @@ MyDetectorConstruction::MyDetectorConstruction(){
                                 CubeSide,
                                 "Side dimensions of the cube");
        
+    fMessengerCube->DeclareMethod("AddCube",
+                              &MyDetectorConstruction::AddCube,
+                              "Add a sweep cube (at most 4): distance from source and side (cm). "
+                              "After /run/initialize, takes effect at /run/reinitializeGeometry");
+
+    fMessengerCube->DeclareMethod("ClearCubes",
+                              &MyDetectorConstruction::ClearCubes,
+                              "Remove all sweep cubes. "
+                              "After /run/initialize, takes effect at /run/reinitializeGeometry");
+
     CubeDistance = 4.0;
     CubeSide     = 1.0;
 
@@ -22,6 +39,43 @@ MyDetectorConstruction::MyDetectorConstruction(){
 
 MyDetectorConstruction::~MyDetectorConstruction(){}
 
+G4int MyDetectorConstruction::CubeCopyNumber(G4double distance, G4double side){
+    G4int d = static_cast<G4int>(std::lround(distance*cm / (0.1*mm)));
+    G4int s = static_cast<G4int>(std::lround(side*cm     / (0.1*mm)));
+    return s*10000 + d;
+}
+
+void MyDetectorConstruction::AddCube(G4double distance, G4double side){
+    for (const auto &cube : fSweepCubes) {
+        if (CubeCopyNumber(cube.first, cube.second) == CubeCopyNumber(distance, side)) {
+            G4cout << "[MyDetectorConstruction] Cube at " << distance << " cm with side "
+                   << side << " cm already added" << G4endl;
+            return;
+        }
+    }
+    if (fSweepCubes.size() >= kMaxSweepCubes) {
+        G4cerr << "[MyDetectorConstruction] Only " << kMaxSweepCubes << " sweep cubes fit the shielding's "
+               << "symmetry: cube at " << distance << " cm with side " << side << " cm not added. "
+               << "Run the rest after /MyCube/ClearCubes and /run/reinitializeGeometry" << G4endl;
+        return;
+    }
+    fSweepCubes.push_back({distance, side});
+    WarnIfBuilt();
+}
+
+void MyDetectorConstruction::ClearCubes(){
+    fSweepCubes.clear();
+    WarnIfBuilt();
+}
+
+void MyDetectorConstruction::WarnIfBuilt() const {
+    // Like CubeDistance/CubeSide, the cubes are placed by Construct() only
+    if (G4StateManager::GetStateManager()->GetCurrentState() == G4State_Idle) {
+        G4cout << "[MyDetectorConstruction] The geometry is already built: the cubes change "
+               << "at the next /run/reinitializeGeometry" << G4endl;
+    }
+}
+
 void MyDetectorConstruction::DefineMaterials(){
 
     G4NistManager *nist = G4NistManager::Instance(); 
@@ -320,44 +374,92 @@ G4VPhysicalVolume *MyDetectorConstruction::Construct(){
     logicFloor->SetVisAttributes(visAttributesFloor);
 
 
-    // Build Cube
+    // Build Cube(s)
+    ConstructCubes(holderHeight);
+
+    DefineRegions();
+
+
+    return physWorld;
+}
+
+void MyDetectorConstruction::ConstructCubes(G4double holderHeight){
 
     G4VisAttributes* visAttributesCube = new G4VisAttributes(G4Colour(1, 1, 1, 0.8));
     visAttributesCube->SetVisibility(true);
     visAttributesCube->SetForceSolid(true);
 
+    fCubeLogicals.clear();
+
+    std::vector<std::pair<G4double, G4double>> cubes = fSweepCubes;
+    G4bool sweep = !cubes.empty();
+    if (!sweep) cubes.push_back({CubeDistance, CubeSide});
+
+    // The Pb blocks, bottom block and floor are only symmetric under quarter
+    // turns about the source axis, so sweep cube i sits at phi = i*90 deg
+    // (the first where the single cube is), turned to face the source. Each
+    // then sees the shielding of a lone cube at phi = 0, and with one cube
+    // per direction none lies in the shadow of another.
+    for (std::size_t i = 0; i < cubes.size(); ++i) {
+        G4double distance = cubes[i].first;
+        G4double side     = cubes[i].second;
+
+        G4LogicalVolume *&logical = fCubeLogicals[side];
+        if (!logical) {
+            solidCube = new G4Box("solidCube",
+                                  side/2 *cm,
+                                  side/2 *cm,
+                                  side/2 *cm
+                                );
 
-    solidCube = new G4Box("solidCube",
-                          CubeSide/2 *cm,
-                          CubeSide/2 *cm,
-                          CubeSide/2 *cm
-                        );
+            logical = new G4LogicalVolume(solidCube,
+                                          LiF,
+                                          "logicCube"
+                                        );
+
+            logical->SetVisAttributes(visAttributesCube);
+        }
+        logicCube = logical;
+
+        G4double phi = 90.*deg * i;
+        G4RotationMatrix rot;
+        rot.rotateZ(phi);
+        G4ThreeVector pos(distance*cm, 0., -20*cm + (2*holderHeight) + side/2*cm);
+        pos.rotateZ(phi);
+
+        G4int copyNo = sweep ? CubeCopyNumber(distance, side) : 0;
+        physCube = new G4PVPlacement(G4Transform3D(rot, pos),
+                                     logical,
+                                     "logicCube",
+                                     logicWorld,
+                                     false,
+                                     copyNo,
+                                     true
+                                    );
+    }
+}
 
-    logicCube = new G4LogicalVolume(solidCube,
-                                    LiF,
-                                    "logicCube"
-                                );
+void MyDetectorConstruction::DefineRegions(){
 
-    physCube = new G4PVPlacement(0,
-                                 G4ThreeVector(CubeDistance*cm, 0., -20*cm + (2*holderHeight) + CubeSide/2*cm ),
-                                 logicCube,
-                                 "logicCube",
-                                 logicWorld,
-                                 false,
-                                 0,
-                                 true
-                                );
+    G4RegionStore *store = G4RegionStore::GetInstance();
 
-    logicCube->SetVisAttributes(visAttributesCube);
+    G4Region *crystals = store->FindOrCreateRegion("Crystals");
+    for (const auto &kv : fCubeLogicals) crystals->AddRootLogicalVolume(kv.second);
 
+    G4Region *shield = store->FindOrCreateRegion("SourceShield");
+    for (G4LogicalVolume *logical : {logicBlockBottom, logicBlockSide1, logicBlockSide2,
+                                     logicBlockSide3, logicBlockSide4, logicCylinder})
+        shield->AddRootLogicalVolume(logical);
 
-    return physWorld;
+    store->FindOrCreateRegion("Structure")->AddRootLogicalVolume(logicFloor);
 }
 
 void MyDetectorConstruction::ConstructSDandField(){
 
+    // Registered so that Initialize() creates the hits collection each event
     MySensitiveDetector *sensDet = new MySensitiveDetector("SensitiveDetector");
-    logicCube->SetSensitiveDetector(sensDet);
+    G4SDManager::GetSDMpointer()->AddNewDetector(sensDet);
+    for (auto &kv : fCubeLogicals) kv.second->SetSensitiveDetector(sensDet);
 
 }
 
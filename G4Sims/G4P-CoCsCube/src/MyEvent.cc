@@ -1 +1,71 @@
+#include "MyEvent.hh"
+#include "MyCrystalHit.hh"
+#include "MyHitWriter.hh"
+#include "MyRunSummary.hh"
 
+#include "G4Event.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4SDManager.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+
+MyEventAction::MyEventAction() : fHCID(-1) {
+};
+
+MyEventAction::~MyEventAction() {
+};
+
+void MyEventAction::BeginOfEventAction(const G4Event *anEvent) {
+};
+
+void MyEventAction::EndOfEventAction(const G4Event *anEvent) {
+
+    Record(anEvent);
+    MyRunSummary::Instance()->EndOfEvent();
+};
+
+void MyEventAction::Record(const G4Event *anEvent) {
+
+    G4HCofThisEvent *hce = anEvent->GetHCofThisEvent();
+    if (!hce) return;
+
+    if (fHCID < 0) fHCID = G4SDManager::GetSDMpointer()->GetCollectionID("SensitiveDetector/CrystalHits");
+    auto hits = static_cast<MyCrystalHitsCollection*>(hce->GetHC(fHCID));
+    if (!hits || hits->entries() == 0) return;
+
+    MyHitWriter  *writer  = MyHitWriter::Instance();
+    MyRunSummary *summary = MyRunSummary::Instance();
+    G4int evt = anEvent->GetEventID();
+
+    fDeposits.clear();
+    G4double totalEdep = 0.;
+    fCopies.clear();
+
+    for (std::size_t i = 0; i < hits->entries(); ++i) {
+        const MyCrystalHit *hit = (*hits)[i];
+        writer->FillTrack(evt, hit);
+        totalEdep += hit->GetEdep();
+        summary->AddDeposit(hit->GetCopyNo(), hit->GetEdep());
+
+        // Only a handful of (copy, particle) pairs per event: linear search
+        Deposit *dep = nullptr;
+        for (auto &d : fDeposits) {
+            if (d.copyNo == hit->GetCopyNo() && d.pdg == hit->GetPDG()) { dep = &d; break; }
+        }
+        if (!dep) {
+            fDeposits.push_back({hit->GetCopyNo(), hit->GetPDG(), 0., 0});
+            dep = &fDeposits.back();
+            if (std::find(fCopies.begin(), fCopies.end(), hit->GetCopyNo()) == fCopies.end())
+                fCopies.push_back(hit->GetCopyNo());
+        }
+        dep->edep += hit->GetEdep();
+        dep->nTracks++;
+    }
+
+    for (const auto &d : fDeposits) {
+        writer->FillDeposit(evt, d.copyNo, d.pdg, d.edep, d.nTracks);
+    }
+
+    writer->FillEvent(evt, static_cast<G4int>(hits->entries()), static_cast<G4int>(fCopies.size()), totalEdep);
+}
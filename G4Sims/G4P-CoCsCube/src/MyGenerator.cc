@@ -1,58 +1,83 @@
 #include "MyGenerator.hh"
+#include "G4AutoLock.hh"
 #include "G4IonTable.hh"
 #include "G4ParticleGun.hh"
 #include "G4ParticleTable.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4ThreeVector.hh"
 
-PrimaryGeneratorAction::PrimaryGeneratorAction() {
+namespace {
+  // The ion definition is shared by all threads; only touch it once
+  G4Mutex sourceIonMutex = G4MUTEX_INITIALIZER;
+  G4bool  sourceIonDecayEnabled = false;
+}
+
+PrimaryGeneratorAction::PrimaryGeneratorAction() : fSourceIon(nullptr) {
   fParticleGun = new G4ParticleGun(1);
 
   fMessengerSource = new G4GenericMessenger(this,
                                             "/MySource/",
                                             "MySource");
 
-  fMessengerSource->DeclareProperty("SourceHeight",
-                                    SourceHeight,
-                                    "Height of source from PLA holder");
+  fMessengerSource->DeclareMethod("SourceHeight",
+                                  &PrimaryGeneratorAction::SetSourceHeight,
+                                  "Height of source from PLA holder");
 
   SourceHeight = 0.5;
+
+  // Set momentum direction (stationary source)
+  fParticleGun->SetParticleMomentumDirection(G4ThreeVector(0., 0., 0.));
+
+  // Set kinetic energy to zero so it remains at rest and undergoes decay
+  fParticleGun->SetParticleEnergy(0.0 * MeV);
+
+  SetSourceHeight(SourceHeight);
 }
 
 
-PrimaryGeneratorAction::~PrimaryGeneratorAction() { delete fParticleGun; }
+PrimaryGeneratorAction::~PrimaryGeneratorAction() {
+  delete fMessengerSource;
+  delete fParticleGun;
+}
+
+void PrimaryGeneratorAction::SetSourceHeight(G4double height) {
+  SourceHeight = height;
 
-void PrimaryGeneratorAction::GeneratePrimaries(G4Event *anEvent) {
+  // Set initial position
+  G4ThreeVector position(0, 0, -20*cm + SourceHeight*cm);
+  fParticleGun->SetParticlePosition(position);
+}
+
+void PrimaryGeneratorAction::DefineSource() {
   G4IonTable *ionTable = G4IonTable::GetIonTable();
 
   // Define Co-60 (Z=27, A=60, Excitation Energy = 0)
-  G4ParticleDefinition *cobalt60 = ionTable->GetIon(27, 60, 0.0);
+  fSourceIon = ionTable->GetIon(27, 60, 0.0);
 
   // Define Cs-137
-  // G4ParticleDefinition *cesium137 = ionTable->GetIon(55, 137, 0.0);
+  // fSourceIon = ionTable->GetIon(55, 137, 0.0);
 
-  if (!cobalt60) {
+  if (!fSourceIon) {
     G4cerr << "Error: Cobalt-60 ion not found in ion table!" << G4endl;
     return;
   }
 
-  //fParticleGun->SetParticleDefinition(cobalt60);
-  fParticleGun->SetParticleDefinition(cobalt60);
+  fParticleGun->SetParticleDefinition(fSourceIon);
   fParticleGun->SetParticleCharge(0); // Ensure neutral Co-60 atom
 
   // **Enable radioactive decay for this particle**
-  cobalt60->SetPDGLifeTime(0.0); // Allow Geant4 to handle decay
-  //cesium137->SetPDGLifeTime(0.0); // Allow Geant4 to handle decay
-
-  // Set initial position
-  G4ThreeVector position(0, 0, -20*cm + SourceHeight*cm);
-  fParticleGun->SetParticlePosition(position);
-
-  // Set momentum direction (stationary source)
-  fParticleGun->SetParticleMomentumDirection(G4ThreeVector(0., 0., 0.));
+  G4AutoLock lock(&sourceIonMutex);
+  if (!sourceIonDecayEnabled) {
+    fSourceIon->SetPDGLifeTime(0.0); // Allow Geant4 to handle decay
+    sourceIonDecayEnabled = true;
+  }
+}
 
-  // Set kinetic energy to zero so it remains at rest and undergoes decay
-  fParticleGun->SetParticleEnergy(0.0 * MeV);
+void PrimaryGeneratorAction::GeneratePrimaries(G4Event *anEvent) {
+  if (!fSourceIon) {
+    DefineSource();
+    if (!fSourceIon) return;
+  }
 
   // Generate the primary vertex
   fParticleGun->GeneratePrimaryVertex(anEvent);
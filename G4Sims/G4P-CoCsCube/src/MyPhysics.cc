@@ -1,12 +1,88 @@
 #include "MyPhysics.hh"
+#include "MyPhysicsCache.hh"
 #include "G4DecayPhysics.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
 #include "G4RadioactiveDecayPhysics.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
 
 MyPhysicsList::MyPhysicsList() {
     RegisterPhysics(new G4EmStandardPhysics());
     RegisterPhysics(new G4DecayPhysics());
     RegisterPhysics(new G4RadioactiveDecayPhysics());
+
+    // Fine where dose is scored, coarse where it is not: secondaries below
+    // the cut deposit their energy on the spot instead of being tracked
+    fRegionCuts["Crystals"]     = 0.1*mm;
+    fRegionCuts["SourceShield"] = 1.*mm;
+    fRegionCuts["Structure"]    = 1.*cm;
+
+    fMessengerCuts = new G4GenericMessenger(this,
+                                            "/phoenix/cuts/",
+                                            "Production cuts per region");
+
+    // The physics list is shared by all threads: set it once, on the master
+    fMessengerCuts->DeclareMethodWithUnit("crystals", "mm",
+                                          &MyPhysicsList::SetCrystalsCut,
+                                          "Range cut in the LiF cubes (before /run/initialize)")
+                  .SetStates(G4State_PreInit)
+                  .SetToBeBroadcasted(false);
+
+    fMessengerCuts->DeclareMethodWithUnit("shield", "mm",
+                                          &MyPhysicsList::SetSourceShieldCut,
+                                          "Range cut in the Pb blocks and source cylinder (before /run/initialize)")
+                  .SetStates(G4State_PreInit)
+                  .SetToBeBroadcasted(false);
+
+    fMessengerCuts->DeclareMethodWithUnit("structure", "mm",
+                                          &MyPhysicsList::SetStructureCut,
+                                          "Range cut in the floor (before /run/initialize)")
+                  .SetStates(G4State_PreInit)
+                  .SetToBeBroadcasted(false);
 };
 
 MyPhysicsList::~MyPhysicsList(){
+    delete fMessengerCuts;
+};
+
+void MyPhysicsList::SetRegionCut(const G4String& region, G4double cut){
+
+    if (cut <= 0.) {
+        G4cout << "[MyPhysicsList] Cut of region '" << region << "' must be positive" << G4endl;
+        return;
+    }
+    fRegionCuts[region] = cut;
+};
+
+void MyPhysicsList::SetCuts(){
+
+    G4VModularPhysicsList::SetCuts();
+
+    // Regions are shared by all threads: set them once, on the master
+    if (G4Threading::IsMasterThread()) ApplyRegionCuts();
+
+    // Geometry, materials and cuts are all known by now
+    MyPhysicsCache::Instance()->Configure(this);
+};
+
+void MyPhysicsList::ApplyRegionCuts() const {
+
+    // Same cut for gammas, e-, e+ and protons of a region
+    const G4ProductionCuts *defaultCuts = G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts();
+    for (const auto &kv : fRegionCuts) {
+        G4Region *region = G4RegionStore::GetInstance()->GetRegion(kv.first, false);
+        if (!region) {
+            G4cout << "[MyPhysicsList] No region '" << kv.first << "' for production cuts" << G4endl;
+            continue;
+        }
+        G4ProductionCuts *cuts = region->GetProductionCuts();
+        if (!cuts || cuts == defaultCuts) {
+            cuts = new G4ProductionCuts();
+            region->SetProductionCuts(cuts);
+        }
+        cuts->SetProductionCut(kv.second);
+    }
 };
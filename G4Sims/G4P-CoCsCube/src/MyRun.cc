@@ -1,79 +1,231 @@
 #include "MyRun.hh"
+#include "MyHitWriter.hh"
+#include "MyProcessDictionary.hh"
+#include "MyPhysicsCache.hh"
+#include "MyRunSummary.hh"
+#include "MyVoxelScorer.hh"
+#include "G4AccumulableManager.hh"
 #include "G4AnalysisManager.hh"
+#include "G4RunManager.hh"
+#include "G4Threading.hh"
 #include <sstream>
+#include <fstream>
+#include <vector>
 #include <cstdio> // for std::rename
 
-MyRunAction::MyRunAction() : fOutputDirectory("./") {
+// Concatenate the per-thread CSV ntuples into one file. The '#' header
+// block is taken from the first part only; parts are removed once the
+// whole target is written, and kept if it could not be.
+static G4bool mergeNtupleFiles(const G4String& target, const std::vector<G4String>& parts) {
 
-    G4AnalysisManager *man = G4AnalysisManager::Instance();
+    std::ofstream out(target, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
 
-    man->CreateNtuple("Hits", "Hits");
-    man->CreateNtupleIColumn("fEvent");
-    man->CreateNtupleIColumn("fEntry");   
-    man->CreateNtupleSColumn("fPreProc");
-    man->CreateNtupleSColumn("fPostProc");
-    man->CreateNtupleIColumn("fTrackID");
-    man->CreateNtupleIColumn("fParentID");
-    man->CreateNtupleIColumn("fPDG");
-    man->CreateNtupleDColumn("fKinetic");
-    man->CreateNtupleDColumn("fEdep");
-    man->CreateNtupleDColumn("fX1");
-    man->CreateNtupleDColumn("fY1");
-    man->CreateNtupleDColumn("fZ1");
-    man->CreateNtupleDColumn("fX2");
-    man->CreateNtupleDColumn("fY2");
-    man->CreateNtupleDColumn("fZ2");
-    man->CreateNtupleIColumn("Copy");
-    man->FinishNtuple(0);
+    G4bool needHeader = true;
+    std::string line;
+    for (const auto &part : parts) {
+        std::ifstream in(part, std::ios::binary);
+        if (!in.is_open()) continue;
 
-}
+        while (in.peek() == '#' && std::getline(in, line)) {
+            if (needHeader) out << line << '\n';
+        }
+        needHeader = false;
 
-MyRunAction::~MyRunAction(){
+        if (in.peek() != std::ifstream::traits_type::eof()) out << in.rdbuf();
+    }
+
+    out.close();
+    if (!out) return false;
+    for (const auto &part : parts) std::remove(part.c_str());
+    return true;
 }
 
-void MyRunAction::BeginOfRunAction(const G4Run* run){
+MyRunAction::MyRunAction() : fOutputDirectory("./"), fOutputFormat("phx"), fWriteSteps(false),
+                             fAsyncOutput(false), fVoxelActive(false), fVoxelGrid(10, 10, 10) {
 
-    G4AnalysisManager *man = G4AnalysisManager::Instance();
+    // Ntuples for the CSV format, one per MyHitWriter table
+    MyHitWriter::BookNtuples();
 
-    G4int runID = run->GetRunID();
+    fMessengerOutput = new G4GenericMessenger(this,
+                                              "/phoenix/output/",
+                                              "Simulation output");
 
-    std::stringstream strRunID;
-    strRunID << runID;
+    fMessengerOutput->DeclareProperty("format",
+                                      fOutputFormat,
+                                      "Output format: phx (binary columnar) or csv")
+                    .SetCandidates("phx csv");
 
-    G4String filename = fOutputDirectory;
-    if (filename.back() != '/') filename += "/";
-    filename += "run_" + strRunID.str() + ".csv";
-    
-    man->SetFileName(filename);
-    man->OpenFile();
+    fMessengerOutput->DeclareProperty("steps",
+                                      fWriteSteps,
+                                      "Also write the raw per-step Hits table (debug)");
+
+    fMessengerOutput->DeclareProperty("async",
+                                      fAsyncOutput,
+                                      "Encode and write PHXC tables on a writer thread per worker (default: false)");
+
+    // Every thread registers its own grid; workers merge into the master's
+    G4AccumulableManager::Instance()->RegisterAccumulable(MyVoxelScorer::Instance());
+    G4AccumulableManager::Instance()->RegisterAccumulable(MyRunSummary::Instance());
+
+    fMessengerVoxel = new G4GenericMessenger(this,
+                                             "/phoenix/voxel/",
+                                             "Voxelised energy deposit in the cube");
+
+    fMessengerVoxel->DeclareProperty("active",
+                                     fVoxelActive,
+                                     "Score deposits on a voxel grid over the cube");
+
+    fMessengerVoxel->DeclareProperty("grid",
+                                     fVoxelGrid,
+                                     "Number of voxels along x y z of the cube");
 
 }
 
-void MyRunAction::EndOfRunAction(const G4Run* run){
+MyRunAction::~MyRunAction(){
+    delete fMessengerOutput;
+    delete fMessengerVoxel;
+}
 
-    G4AnalysisManager *man = G4AnalysisManager::Instance();
-    man->Write();
-    man->CloseFile();
+G4String MyRunAction::RunFileBase(const G4Run* run) const {
 
-    // Geant4 CSV backend creates files named like
-    // <basename>_nt_Hits.csv (nt_ + ntuple name). Rename that to
-    // <basename>.csv if present so the file is simply run_<id>.csv.
-    G4int runID = run->GetRunID();
     std::stringstream strRunID;
-    strRunID << runID;
+    strRunID << run->GetRunID();
 
     G4String base = fOutputDirectory;
     if (base.size() == 0) base = "./";
     if (base.back() != '/') base += "/";
+    return base + "run_" + strRunID.str();
+}
+
+void MyRunAction::BeginOfRunAction(const G4Run* run){
+
+    if (IsMaster()) fTimer.Start();
+
+    // The physics tables have just been built for this run
+    if (IsMaster()) MyPhysicsCache::Instance()->StoreIfPending();
 
-    G4String produced = base + "run_" + strRunID.str() + "_nt_Hits.csv";
-    G4String desired  = base + "run_" + strRunID.str() + ".csv";
+    // Process codes used by the hit rows; the master writes the side table
+    MyProcessDictionary::Instance()->Build();
+    if (IsMaster()) MyProcessDictionary::Instance()->Write(RunFileBase(run) + "_processes.csv");
 
-    // Try to rename; if it fails, print a message but continue.
-    if (std::rename(produced.c_str(), desired.c_str()) != 0) {
-        G4cout << "[MyRunAction] Could not rename '" << produced << "' to '" << desired << "' - file may not exist or permission denied." << G4endl;
+    MyHitWriter::Instance()->SetWriteSteps(fWriteSteps);
+    MyHitWriter::Instance()->SetAsync(fAsyncOutput);
+
+    MyVoxelScorer *voxels = MyVoxelScorer::Instance();
+    voxels->SetActive(fVoxelActive);
+    voxels->SetGrid(static_cast<G4int>(fVoxelGrid.x()),
+                    static_cast<G4int>(fVoxelGrid.y()),
+                    static_cast<G4int>(fVoxelGrid.z()));
+    G4AccumulableManager::Instance()->Reset();
+
+    if (fOutputFormat == "phx") {
+        // The master has no sensitive detector in MT mode; it only merges
+        if (IsMaster() && G4Threading::IsMultithreadedApplication()) return;
+
+        G4String suffix = "";
+        if (G4Threading::IsWorkerThread()) suffix = "_t" + std::to_string(G4Threading::G4GetThreadId());
+        MyHitWriter::Instance()->Open(RunFileBase(run), suffix);
+        return;
+    }
+
+    G4AnalysisManager *man = G4AnalysisManager::Instance();
+
+    man->SetActivation(true);
+    man->SetNtupleActivation(MyHitWriter::kHits, fWriteSteps);
+    man->SetFileName(RunFileBase(run) + ".csv");
+    man->OpenFile();
+
+}
+
+void MyRunAction::EndOfRunAction(const G4Run* run){
+
+    if (fOutputFormat == "phx") {
+        MyHitWriter::Instance()->Close();
     } else {
-        G4cout << "[MyRunAction] Renamed output file to '" << desired << "'" << G4endl;
+        G4AnalysisManager *man = G4AnalysisManager::Instance();
+        man->Write();
+        man->CloseFile();
+    }
+
+    // Workers add their voxel grids to the master's; no-op on the master
+    G4AccumulableManager::Instance()->Merge();
+
+    // Workers only close their own ntuple; the master assembles the run file
+    if (!IsMaster()) return;
+
+    FinaliseOutput(run);
+
+    if (fVoxelActive) MyVoxelScorer::Instance()->Write(RunFileBase(run) + "_Voxels.phx");
+
+    fTimer.Stop();
+    G4int    nEvents = run->GetNumberOfEvent();
+    G4double seconds = fTimer.GetRealElapsed();
+    G4cout << "[MyRunAction] Run " << run->GetRunID() << ": " << nEvents << " events in "
+           << seconds << " s (" << (seconds > 0. ? nEvents / seconds : 0.) << " events/s, "
+           << G4RunManager::GetRunManager()->GetNumberOfThreads() << " threads)" << G4endl;
+    MyRunSummary::Instance()->Report(RunFileBase(run) + "_summary.csv", seconds);
+
+}
+
+void MyRunAction::FinaliseOutput(const G4Run* run) const {
+
+    G4String base = RunFileBase(run);
+    G4int nThreads = G4RunManager::GetRunManager()->GetNumberOfThreads();
+
+    for (G4int table = 0; table < MyHitWriter::kNTables; ++table) {
+        if (table == MyHitWriter::kHits && !fWriteSteps) continue;
+
+        G4String tableName = MyHitWriter::TableName(table);
+
+        if (fOutputFormat == "phx") {
+            // Sequential runs write run_<id>_<Table>.phx directly
+            if (!G4Threading::IsMultithreadedApplication()) continue;
+
+            std::vector<std::string> parts;
+            for (G4int i = 0; i < nThreads; ++i) {
+                parts.push_back(base + "_" + tableName + "_t" + std::to_string(i) + ".phx");
+            }
+            // The thread files stay for a manual phoenix_merge unless merged
+            try {
+                if (!mergeColumnFiles(base + "_" + tableName + ".phx", parts)) continue;
+                G4cout << "[MyRunAction] Merged " << nThreads << " thread outputs into '" << base << "_" << tableName << ".phx'" << G4endl;
+            } catch (const std::exception& e) {
+                G4cerr << "[MyRunAction] Merge into '" << base << "_" << tableName << ".phx' failed: " << e.what() << G4endl;
+                continue;
+            }
+            for (const auto &part : parts) std::remove(part.c_str());
+            continue;
+        }
+
+        // Geant4 CSV backend creates files named like
+        // <basename>_nt_<Table>.csv (nt_ + ntuple name), or <basename>_nt_<Table>_t<i>.csv
+        // per worker thread. Rename or merge those so the step file is simply
+        // run_<id>.csv and the others run_<id>_<Table>.csv.
+        G4String produced = base + "_nt_" + tableName + ".csv";
+        G4String desired  = base + (table == MyHitWriter::kHits ? G4String("") : "_" + tableName) + ".csv";
+
+        if (G4Threading::IsMultithreadedApplication()) {
+            std::vector<G4String> parts;
+            for (G4int i = 0; i < nThreads; ++i) {
+                parts.push_back(base + "_nt_" + tableName + "_t" + std::to_string(i) + ".csv");
+            }
+
+            if (mergeNtupleFiles(desired, parts)) {
+                std::remove(produced.c_str()); // header-only master ntuple, if any
+                G4cout << "[MyRunAction] Merged " << nThreads << " thread outputs into '" << desired << "'" << G4endl;
+            } else {
+                G4cout << "[MyRunAction] Could not write '" << desired << "'" << G4endl;
+            }
+            continue;
+        }
+
+        // Try to rename; if it fails, print a message but continue.
+        if (std::rename(produced.c_str(), desired.c_str()) != 0) {
+            G4cout << "[MyRunAction] Could not rename '" << produced << "' to '" << desired << "' - file may not exist or permission denied." << G4endl;
+        } else {
+            G4cout << "[MyRunAction] Renamed output file to '" << desired << "'" << G4endl;
+        }
     }
 
 }
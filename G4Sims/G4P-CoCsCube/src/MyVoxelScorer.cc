@@ -0,0 +1,128 @@
+#include "MyVoxelScorer.hh"
+#include "ColumnFile.hh"
+
+#include "G4Box.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4NavigationHistory.hh"
+#include "G4Step.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4VTouchable.hh"
+
+#include <algorithm>
+
+MyVoxelScorer* MyVoxelScorer::Instance() {
+    static G4ThreadLocal MyVoxelScorer* instance = nullptr;
+    if (!instance) instance = new MyVoxelScorer();
+    return instance;
+}
+
+MyVoxelScorer::MyVoxelScorer()
+    : G4VAccumulable("VoxelScorer"), fActive(false), fNx(10), fNy(10), fNz(10) {
+}
+
+void MyVoxelScorer::SetGrid(G4int nx, G4int ny, G4int nz) {
+    fNx = std::max(1, nx);
+    fNy = std::max(1, ny);
+    fNz = std::max(1, nz);
+}
+
+void MyVoxelScorer::Score(const G4Step* step, G4int copyNo) {
+
+    G4double edep = step->GetTotalEnergyDeposit();
+    if (edep <= 0.) return;
+
+    const G4StepPoint   *pre       = step->GetPreStepPoint();
+    const G4VTouchable  *touchable = pre->GetTouchable();
+
+    auto it = fGrids.find(copyNo);
+    if (it == fGrids.end()) {
+        // First deposit in this copy: take its size and density from the geometry
+        auto box = static_cast<const G4Box*>(touchable->GetSolid());
+        Grid grid;
+        grid.halfSize = G4ThreeVector(box->GetXHalfLength(), box->GetYHalfLength(), box->GetZHalfLength());
+        grid.density  = touchable->GetVolume()->GetLogicalVolume()->GetMaterial()->GetDensity();
+        grid.edep  .assign(fNx * fNy * fNz, 0.);
+        grid.nSteps.assign(fNx * fNy * fNz, 0);
+        it = fGrids.emplace(copyNo, grid).first;
+    }
+    Grid &grid = it->second;
+
+    G4ThreeVector mid   = 0.5 * (pre->GetPosition() + step->GetPostStepPoint()->GetPosition());
+    G4ThreeVector local = touchable->GetHistory()->GetTopTransform().TransformPoint(mid);
+
+    G4int ix = static_cast<G4int>((local.x() + grid.halfSize.x()) / (2. * grid.halfSize.x()) * fNx);
+    G4int iy = static_cast<G4int>((local.y() + grid.halfSize.y()) / (2. * grid.halfSize.y()) * fNy);
+    G4int iz = static_cast<G4int>((local.z() + grid.halfSize.z()) / (2. * grid.halfSize.z()) * fNz);
+    ix = std::min(std::max(ix, 0), fNx - 1);
+    iy = std::min(std::max(iy, 0), fNy - 1);
+    iz = std::min(std::max(iz, 0), fNz - 1);
+
+    std::size_t index = (static_cast<std::size_t>(ix) * fNy + iy) * fNz + iz;
+    grid.edep[index] += edep;
+    grid.nSteps[index]++;
+}
+
+void MyVoxelScorer::Merge(const G4VAccumulable& other) {
+
+    const auto &worker = static_cast<const MyVoxelScorer&>(other);
+    for (const auto &kv : worker.fGrids) {
+        auto it = fGrids.find(kv.first);
+        if (it == fGrids.end()) {
+            fGrids.emplace(kv.first, kv.second);
+            continue;
+        }
+        for (std::size_t i = 0; i < kv.second.edep.size(); ++i) {
+            it->second.edep[i]   += kv.second.edep[i];
+            it->second.nSteps[i] += kv.second.nSteps[i];
+        }
+    }
+}
+
+void MyVoxelScorer::Reset() {
+    fGrids.clear();
+}
+
+void MyVoxelScorer::Write(const G4String& path) const {
+
+    ColumnWriter writer(path, {
+        {"Copy",    ColumnType::Int32},
+        {"iX",      ColumnType::Int16},
+        {"iY",      ColumnType::Int16},
+        {"iZ",      ColumnType::Int16},
+        {"fX",      ColumnType::Float64},  // voxel centre, crystal frame (mm)
+        {"fY",      ColumnType::Float64},
+        {"fZ",      ColumnType::Float64},
+        {"fEdep",   ColumnType::Float64},  // MeV
+        {"fDose",   ColumnType::Float64},  // Gy
+        {"fNSteps", ColumnType::Int32}
+    });
+
+    for (const auto &kv : fGrids) {
+        const Grid &grid = kv.second;
+        G4ThreeVector size(2. * grid.halfSize.x() / fNx,
+                           2. * grid.halfSize.y() / fNy,
+                           2. * grid.halfSize.z() / fNz);
+        G4double mass = grid.density * size.x() * size.y() * size.z();
+
+        for (G4int ix = 0; ix < fNx; ++ix) {
+            for (G4int iy = 0; iy < fNy; ++iy) {
+                for (G4int iz = 0; iz < fNz; ++iz) {
+                    std::size_t index = (static_cast<std::size_t>(ix) * fNy + iy) * fNz + iz;
+                    writer.fill<std::int32_t>(0, kv.first);
+                    writer.fill<std::int16_t>(1, ix);
+                    writer.fill<std::int16_t>(2, iy);
+                    writer.fill<std::int16_t>(3, iz);
+                    writer.fill<double>(4, -grid.halfSize.x() + (ix + 0.5) * size.x());
+                    writer.fill<double>(5, -grid.halfSize.y() + (iy + 0.5) * size.y());
+                    writer.fill<double>(6, -grid.halfSize.z() + (iz + 0.5) * size.z());
+                    writer.fill<double>(7, grid.edep[index] / MeV);
+                    writer.fill<double>(8, grid.edep[index] / mass / gray);
+                    writer.fill<std::int32_t>(9, grid.nSteps[index]);
+                    writer.addRow();
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef MY_PHYSICS_CACHE_HH
+#define MY_PHYSICS_CACHE_HH
+
+#include <string>
+
+#include "globals.hh"
+
+class G4VModularPhysicsList;
+
+// Warm start: physics tables are stored under <directory>/<hash>/, where the
+// hash covers the Geant4 version, the physics constructors, the EM
+// parameters, every material and the production cuts of every region. A run
+// whose fingerprint matches an entry retrieves the tables from it; any
+// mismatch simply builds (and stores) a new entry. Master thread only.
+class MyPhysicsCache {
+    public:
+        static MyPhysicsCache* Instance();
+
+        void SetDirectory(const G4String& dir) { fDirectory = dir; }
+        const G4String& GetDirectory() const { return fDirectory; }
+
+        // Once the geometry and cuts are known (MyPhysicsList::SetCuts):
+        // retrieve on a hit, remember to store on a miss
+        void Configure(G4VModularPhysicsList* physicsList);
+
+        // Once the tables are built (master BeginOfRunAction)
+        void StoreIfPending();
+
+    private:
+        MyPhysicsCache();
+
+        static std::string Fingerprint(const G4VModularPhysicsList* physicsList);
+        static std::string Hash(const std::string& text);
+
+        G4String               fDirectory;
+        G4String               fEntry;
+        std::string            fFingerprint;
+        G4bool                 fPending;
+        G4VModularPhysicsList* fPhysicsList;
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef MY_PROCESS_DICTIONARY_HH
+#define MY_PROCESS_DICTIONARY_HH
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "G4String.hh"
+#include "G4VProcess.hh"
+#include "globals.hh"
+
+// Thread-local map from processes to small integer codes. Codes are
+// assigned from the sorted process-name list, so every thread (and the
+// master, which writes the side table) agrees on them. Code 0 is "NA".
+class MyProcessDictionary {
+    public:
+        static MyProcessDictionary* Instance();
+
+        // Rebuild from the G4ProcessTable; called at the start of every run
+        void Build();
+
+        // Hot path: a hash lookup on the process pointer, no allocation
+        G4int Code(const G4VProcess* proc) {
+            if (!proc) return 0;
+            auto it = fCodes.find(proc);
+            if (it != fCodes.end()) return it->second;
+            return Intern(proc);
+        }
+
+        const G4String& Name(G4int code) const { return fNames[code]; }
+        std::size_t Size() const { return fNames.size(); }
+
+        // Side table "code,name"
+        void Write(const G4String& path) const;
+
+    private:
+        MyProcessDictionary();
+
+        G4int Intern(const G4VProcess* proc);
+
+        std::vector<G4String> fNames;
+        std::map<G4String, G4int> fByName;
+        std::unordered_map<const G4VProcess*, G4int> fCodes;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef MY_RUN_SUMMARY_HH
+#define MY_RUN_SUMMARY_HH
+
+#include <iosfwd>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+
+// End-of-run figures for comparing configurations (region cuts, physics
+// profiles): the production cut of every region, the statistical accuracy
+// of the per-event deposit in each crystal copy, and the figure of merit
+// FOM = 1 / (relErr^2 * T). At equal accuracy the run time scales as
+// 1/FOM, so two runs give the time saved as 1 - FOM_a / FOM_b.
+//
+// One instance per thread collects the events; the G4AccumulableManager
+// merges the workers into the master's at end of run, and the master
+// prints and writes the summary with Report().
+class MyRunSummary : public G4VAccumulable {
+    public:
+        static MyRunSummary* Instance();
+
+        // During an event: deposit (weighted, if biased) in a crystal copy
+        void AddDeposit(G4int copyNo, G4double edep);
+        // Once per scored event, including those without a deposit
+        void EndOfEvent();
+
+        // Master: extra "key,value" rows for the next Report(); cleared by
+        // Reset()
+        void Set(const G4String& key, const G4String& value);
+        void Set(const G4String& key, G4double value);
+
+        virtual void Merge(const G4VAccumulable& other);
+        virtual void Reset();
+
+        // Master: prints the summary of a run of the given wall time and
+        // writes it as "key,value" rows to path
+        void Report(const G4String& path, G4double seconds) const;
+
+        // Checkpoints of sequential runs: the event count and the per-copy
+        // sums. Load also takes the wall time of the loaded events, which
+        // Report() adds to its own. Reset() clears both.
+        void Save(std::ostream& out) const;
+        G4bool Load(std::istream& in, G4double seconds);
+
+    private:
+        MyRunSummary();
+
+        struct Sums {
+            G4double sum  = 0.;
+            G4double sum2 = 0.;
+        };
+
+        G4long fEvents;
+        // Wall time of the events loaded from a checkpoint
+        G4double fSecondsBefore;
+        std::map<G4int, Sums> fCopies;
+        // Deposits of the current event, per copy
+        std::vector<std::pair<G4int, G4double>> fEvent;
+        std::vector<std::pair<G4String, G4String>> fExtra;
+};
+
+#endif
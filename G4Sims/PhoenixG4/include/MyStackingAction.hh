@@ -0,0 +1,41 @@
+#ifndef MY_STACKING_ACTION_HH
+#define MY_STACKING_ACTION_HH
+
+#include <set>
+
+#include "G4UserStackingAction.hh"
+#include "G4GenericMessenger.hh"
+
+// Stacking policy set from /phoenix/stack/:
+//  - particles on the kill list (neutrinos by default) are dropped at birth
+//  - e-, e+ and gamma secondaries below deferBelow wait for a later stage
+//  - with abortUseless, a stage made only of deferred e- born outside
+//    every sensitive volume is dropped, which ends the event
+class MyStackingAction : public G4UserStackingAction {
+    public:
+        MyStackingAction();
+        ~MyStackingAction();
+
+        virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track *aTrack);
+
+        virtual void NewStage();
+
+        virtual void PrepareNewEvent(); 
+
+        void KillParticle(G4int pdg) { fKillList.insert(pdg); }
+        void KeepParticle(G4int pdg) { fKillList.erase(pdg); }
+
+    private:
+        std::set<G4int> fKillList;
+        G4double        fDeferEnergy;
+        G4bool          fAbortUseless;
+
+        // Deferred tracks of the coming stage, and how many of them could
+        // still deposit in a crystal
+        G4int fNWaiting;
+        G4int fNReachable;
+
+        G4GenericMessenger* fMessenger;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include "MyPhysicsCache.hh"
+
+#include "G4Element.hh"
+#include "G4EmParameters.hh"
+#include "G4Material.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4Threading.hh"
+#include "G4VModularPhysicsList.hh"
+#include "G4VPhysicsConstructor.hh"
+#include "G4Version.hh"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h> // for getpid
+
+namespace fs = std::filesystem;
+
+MyPhysicsCache* MyPhysicsCache::Instance() {
+    static MyPhysicsCache instance;
+    return &instance;
+}
+
+MyPhysicsCache::MyPhysicsCache() : fPending(false), fPhysicsList(nullptr) {
+}
+
+std::string MyPhysicsCache::Fingerprint(const G4VModularPhysicsList* physicsList) {
+
+    std::ostringstream os;
+    os << std::setprecision(12);
+
+    os << "geant4 " << G4Version << "\n";
+
+    for (G4int i = 0; physicsList->GetPhysics(i) != nullptr; ++i) {
+        const G4VPhysicsConstructor *ctor = physicsList->GetPhysics(i);
+        os << "physics " << ctor->GetPhysicsName() << " " << ctor->GetPhysicsType()
+           << " " << ctor->GetVerboseLevel() << "\n";
+    }
+
+    G4EmParameters::Instance()->StreamInfo(os);
+
+    for (const G4Material *mat : *G4Material::GetMaterialTable()) {
+        os << "material " << mat->GetName() << " " << mat->GetDensity() << " "
+           << mat->GetState() << " " << mat->GetTemperature() << " " << mat->GetPressure() << "\n";
+        for (std::size_t i = 0; i < mat->GetNumberOfElements(); ++i) {
+            const G4Element *el = mat->GetElement(i);
+            os << "  element " << el->GetName() << " " << el->GetZ() << " " << el->GetA()
+               << " " << mat->GetFractionVector()[i] << "\n";
+        }
+    }
+
+    G4ProductionCutsTable *cutsTable = G4ProductionCutsTable::GetProductionCutsTable();
+    os << "energyRange " << cutsTable->GetLowEdgeEnergy() << " " << cutsTable->GetHighEdgeEnergy() << "\n";
+    os << "defaultCut " << physicsList->GetDefaultCutValue() << "\n";
+
+    for (const G4Region *region : *G4RegionStore::GetInstance()) {
+        const G4ProductionCuts *cuts = region->GetProductionCuts();
+        os << "region " << region->GetName();
+        if (cuts) {
+            for (const char *particle : {"gamma", "e-", "e+", "proton"}) {
+                os << " " << cuts->GetProductionCut(particle);
+            }
+        }
+        os << "\n";
+    }
+
+    return os.str();
+}
+
+// 64-bit FNV-1a: entries only need to be distinct, the fingerprint itself
+// is compared in full before reuse
+std::string MyPhysicsCache::Hash(const std::string& text) {
+    std::uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : text) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    std::ostringstream os;
+    os << std::hex << std::setw(16) << std::setfill('0') << h;
+    return os.str();
+}
+
+void MyPhysicsCache::Configure(G4VModularPhysicsList* physicsList) {
+
+    if (fDirectory.empty() || !G4Threading::IsMasterThread()) return;
+
+    fPhysicsList = physicsList;
+    fFingerprint = Fingerprint(physicsList);
+    fEntry       = fDirectory + "/" + Hash(fFingerprint);
+
+    std::ifstream in(fEntry + "/fingerprint.txt", std::ios::binary);
+    std::stringstream stored;
+    if (in.is_open()) stored << in.rdbuf();
+
+    if (in.is_open() && stored.str() == fFingerprint) {
+        G4cout << "[MyPhysicsCache] Retrieving physics tables from '" << fEntry << "'" << G4endl;
+        physicsList->SetPhysicsTableRetrieved(fEntry);
+        fPending = false;
+    } else {
+        G4cout << "[MyPhysicsCache] No tables for this configuration; they will be built and stored in '"
+               << fEntry << "'" << G4endl;
+        fPending = true;
+    }
+}
+
+void MyPhysicsCache::StoreIfPending() {
+
+    if (!fPending) return;
+    fPending = false;
+
+    // Stored aside and renamed into place, so that concurrent jobs never see
+    // a partial entry; whoever renames first wins
+    G4String tmp = fEntry + ".tmp" + std::to_string(getpid());
+    std::error_code ec;
+    fs::create_directories(tmp.c_str(), ec);
+
+    if (ec || !fPhysicsList->StorePhysicsTable(tmp)) {
+        G4cout << "[MyPhysicsCache] Could not store physics tables in '" << tmp << "'" << G4endl;
+        fs::remove_all(tmp.c_str(), ec);
+        return;
+    }
+
+    std::ofstream(tmp + "/fingerprint.txt", std::ios::binary) << fFingerprint;
+
+    fs::rename(tmp.c_str(), fEntry.c_str(), ec);
+    if (ec) fs::remove_all(tmp.c_str(), ec);
+    else G4cout << "[MyPhysicsCache] Stored physics tables in '" << fEntry << "'" << G4endl;
+}
@@ -0,0 +1,69 @@
+#include "MyProcessDictionary.hh"
+#include "G4ProcessTable.hh"
+#include "G4ProcessVector.hh"
+#include <algorithm>
+#include <fstream>
+
+MyProcessDictionary* MyProcessDictionary::Instance() {
+    static G4ThreadLocal MyProcessDictionary* instance = nullptr;
+    if (!instance) instance = new MyProcessDictionary();
+    return instance;
+}
+
+MyProcessDictionary::MyProcessDictionary() {
+    fNames.push_back("NA");
+}
+
+void MyProcessDictionary::Build() {
+
+    G4ProcessTable *table = G4ProcessTable::GetProcessTable();
+
+    std::vector<G4String> names(*table->GetNameList());
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+
+    fNames.assign(1, "NA");
+    fByName.clear();
+    fCodes.clear();
+    for (const auto &name : names) {
+        fByName[name] = static_cast<G4int>(fNames.size());
+        fNames.push_back(name);
+    }
+
+    G4ProcessVector *procs = table->FindProcesses();
+    for (std::size_t i = 0; i < procs->size(); ++i) {
+        const G4VProcess *proc = (*procs)[i];
+        fCodes[proc] = fByName[proc->GetProcessName()];
+    }
+    delete procs;
+}
+
+G4int MyProcessDictionary::Intern(const G4VProcess* proc) {
+
+    // A process that was not in the table when the run started. Give it
+    // the code of a known name, or append it (then it is thread-specific).
+    const G4String &name = proc->GetProcessName();
+    auto it = fByName.find(name);
+    G4int code;
+    if (it != fByName.end()) {
+        code = it->second;
+    } else {
+        code = static_cast<G4int>(fNames.size());
+        fByName[name] = code;
+        fNames.push_back(name);
+        G4cout << "[MyProcessDictionary] Process '" << name << "' not in the process table, assigned code " << code << G4endl;
+    }
+    fCodes[proc] = code;
+    return code;
+}
+
+void MyProcessDictionary::Write(const G4String& path) const {
+
+    std::ofstream fout(path);
+    if (!fout.is_open()) return;
+
+    fout << "code,name\n";
+    for (std::size_t i = 0; i < fNames.size(); ++i) {
+        fout << i << "," << fNames[i] << "\n";
+    }
+}
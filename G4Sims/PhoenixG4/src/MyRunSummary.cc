@@ -0,0 +1,159 @@
+#include "MyRunSummary.hh"
+
+#include "G4ProductionCuts.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <sstream>
+
+MyRunSummary* MyRunSummary::Instance() {
+    static G4ThreadLocal MyRunSummary* instance = nullptr;
+    if (!instance) instance = new MyRunSummary();
+    return instance;
+}
+
+MyRunSummary::MyRunSummary() : G4VAccumulable("RunSummary"), fEvents(0), fSecondsBefore(0.) {
+}
+
+void MyRunSummary::AddDeposit(G4int copyNo, G4double edep) {
+
+    // Only a handful of copies per event: linear search
+    for (auto &e : fEvent) {
+        if (e.first == copyNo) { e.second += edep; return; }
+    }
+    fEvent.emplace_back(copyNo, edep);
+}
+
+void MyRunSummary::EndOfEvent() {
+
+    // Copies without a deposit add zero to both sums
+    for (const auto &e : fEvent) {
+        Sums &s = fCopies[e.first];
+        s.sum  += e.second;
+        s.sum2 += e.second * e.second;
+    }
+    fEvent.clear();
+    ++fEvents;
+}
+
+void MyRunSummary::Set(const G4String& key, const G4String& value) {
+
+    for (auto &kv : fExtra) {
+        if (kv.first == key) { kv.second = value; return; }
+    }
+    fExtra.emplace_back(key, value);
+}
+
+void MyRunSummary::Set(const G4String& key, G4double value) {
+    std::ostringstream text;
+    text << value;
+    Set(key, text.str());
+}
+
+void MyRunSummary::Merge(const G4VAccumulable& other) {
+
+    const auto &worker = static_cast<const MyRunSummary&>(other);
+    fEvents += worker.fEvents;
+    for (const auto &kv : worker.fCopies) {
+        Sums &s = fCopies[kv.first];
+        s.sum  += kv.second.sum;
+        s.sum2 += kv.second.sum2;
+    }
+}
+
+void MyRunSummary::Reset() {
+    fEvents = 0;
+    fSecondsBefore = 0.;
+    fCopies.clear();
+    fEvent.clear();
+    fExtra.clear();
+}
+
+void MyRunSummary::Save(std::ostream& out) const {
+
+    auto put = [&out](const void* p, std::size_t n) { out.write(static_cast<const char*>(p), n); };
+
+    G4long nCopies = static_cast<G4long>(fCopies.size());
+    put(&fEvents, sizeof(fEvents));
+    put(&nCopies, sizeof(nCopies));
+    for (const auto &kv : fCopies) {
+        put(&kv.first, sizeof(kv.first));
+        put(&kv.second.sum, sizeof(kv.second.sum));
+        put(&kv.second.sum2, sizeof(kv.second.sum2));
+    }
+}
+
+G4bool MyRunSummary::Load(std::istream& in, G4double seconds) {
+
+    auto get = [&in](void* p, std::size_t n) { return bool(in.read(static_cast<char*>(p), n)); };
+
+    G4long events, nCopies;
+    if (!get(&events, sizeof(events)) || !get(&nCopies, sizeof(nCopies))) return false;
+    std::map<G4int, Sums> copies;
+    for (G4long k = 0; k < nCopies; ++k) {
+        G4int copyNo;
+        Sums sums;
+        if (!get(&copyNo, sizeof(copyNo)) || !get(&sums.sum, sizeof(sums.sum)) || !get(&sums.sum2, sizeof(sums.sum2)))
+            return false;
+        copies[copyNo] = sums;
+    }
+    fEvents        = events;
+    fCopies        = std::move(copies);
+    fSecondsBefore = seconds;
+    return true;
+}
+
+void MyRunSummary::Report(const G4String& path, G4double runSeconds) const {
+
+    // A resumed run also took the time before its restart
+    const G4double seconds = runSeconds + fSecondsBefore;
+
+    std::ofstream fout(path);
+    if (!fout.is_open()) G4cout << "[MyRunSummary] Could not open '" << path << "'" << G4endl;
+
+    fout << "key,value\n"
+         << "events," << fEvents << "\n"
+         << "seconds," << seconds << "\n"
+         << "events_per_s," << (seconds > 0. ? fEvents / seconds : 0.) << "\n";
+    for (const auto &kv : fExtra) fout << kv.first << "," << kv.second << "\n";
+
+    // Range cut of every region with cuts of its own (gamma, e-, e+ and
+    // proton share one in these simulations)
+    G4cout << "[MyRunSummary] Region cuts:";
+    for (const G4Region *region : *G4RegionStore::GetInstance()) {
+        const G4ProductionCuts *cuts = region->GetProductionCuts();
+        if (!cuts) continue;
+        G4double cut = cuts->GetProductionCut("gamma");
+        G4cout << " " << region->GetName() << " " << cut / mm << " mm";
+        fout << "cut_" << region->GetName() << "_mm," << cut / mm << "\n";
+    }
+    G4cout << G4endl;
+
+    // Mean deposit per event in each copy, its relative standard error and
+    // figure of merit. The worst copy decides how long a run must be.
+    G4double worstFom = -1.;
+    for (const auto &kv : fCopies) {
+        G4double mean   = kv.second.sum / fEvents;
+        G4double var    = std::max(0., kv.second.sum2 / fEvents - mean * mean);
+        G4double relErr = mean > 0. ? std::sqrt(var / fEvents) / mean : 0.;
+        G4double fom    = (relErr > 0. && seconds > 0.) ? 1. / (relErr * relErr * seconds) : 0.;
+        if (fom > 0. && (worstFom < 0. || fom < worstFom)) worstFom = fom;
+
+        G4cout << "[MyRunSummary] Copy " << kv.first << ": " << mean / MeV << " MeV per event, relative error "
+               << relErr << ", FOM " << fom << " /s" << G4endl;
+        fout << "edep_mean_MeV_" << kv.first << "," << mean / MeV << "\n"
+             << "edep_relerr_" << kv.first << "," << relErr << "\n"
+             << "fom_" << kv.first << "," << fom << "\n";
+    }
+    if (worstFom > 0.) {
+        G4cout << "[MyRunSummary] Worst-copy FOM " << worstFom << " /s over " << fEvents << " events in "
+               << seconds << " s; summary in " << path << G4endl;
+        fout << "fom_worst," << worstFom << "\n";
+    }
+}
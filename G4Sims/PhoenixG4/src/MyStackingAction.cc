@@ -0,0 +1,76 @@
+#include "MyStackingAction.hh"
+
+#include "G4Track.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4StackManager.hh"
+#include "G4SystemOfUnits.hh"
+
+MyStackingAction::MyStackingAction()
+    : fDeferEnergy(0.), fAbortUseless(false), fNWaiting(0), fNReachable(0) {
+
+    // Neutrinos never deposit anything in the crystals
+    fKillList = {12, -12, 14, -14, 16, -16};
+
+    fMessenger = new G4GenericMessenger(this,
+                                        "/phoenix/stack/",
+                                        "Track stacking policy");
+
+    fMessenger->DeclareMethod("kill",
+                              &MyStackingAction::KillParticle,
+                              "Drop tracks with this PDG code at birth");
+
+    fMessenger->DeclareMethod("keep",
+                              &MyStackingAction::KeepParticle,
+                              "Remove a PDG code from the kill list");
+
+    fMessenger->DeclarePropertyWithUnit("deferBelow",
+                                        "keV",
+                                        fDeferEnergy,
+                                        "Defer e-/e+/gamma secondaries below this energy to a later stage (0 = off)");
+
+    fMessenger->DeclareProperty("abortUseless",
+                                fAbortUseless,
+                                "End the event when no deferred track can still reach a crystal");
+};
+
+MyStackingAction::~MyStackingAction() {
+    delete fMessenger;
+};
+
+G4ClassificationOfNewTrack MyStackingAction::ClassifyNewTrack(const G4Track* track) {
+
+    G4int pdg = track->GetDefinition()->GetPDGEncoding();
+    if (fKillList.count(pdg)) return fKill;
+
+    // Primaries and anything above the threshold are tracked right away
+    if (track->GetParentID() == 0 || track->GetKineticEnergy() >= fDeferEnergy) return fUrgent;
+    if (pdg != 22 && pdg != 11 && pdg != -11) return fUrgent;
+
+    // Secondaries already carry the touchable of their birth point
+    G4bool inCrystal = false;
+    const G4VPhysicalVolume *volume = track->GetVolume();
+    if (volume) inCrystal = (volume->GetLogicalVolume()->GetSensitiveDetector() != nullptr);
+
+    // Photons, and positrons through their annihilation photons, can reach
+    // a crystal from anywhere
+    ++fNWaiting;
+    if (pdg == 22 || pdg == -11 || inCrystal) ++fNReachable;
+
+    return fWaiting;
+};
+
+void MyStackingAction::NewStage() {
+
+    // Only low-energy e- born outside the crystals are left: they stop
+    // before reaching one
+    if (fAbortUseless && fNWaiting > 0 && fNReachable == 0) stackManager->clear();
+
+    fNWaiting   = 0;
+    fNReachable = 0;
+};
+
+void MyStackingAction::PrepareNewEvent() {
+    fNWaiting   = 0;
+    fNReachable = 0;
+};   
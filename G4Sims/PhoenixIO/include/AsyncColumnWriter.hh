@@ -0,0 +1,253 @@
+// AsyncColumnWriter.hh
+//
+// Moves PHXC encoding and file I/O off the producing thread. Rows are
+// staged column by column, copied as one fixed-size record into a bounded
+// lock-free single-producer/single-consumer ring, and a dedicated writer
+// thread drains the ring into ColumnWriters, which write large blocks.
+//
+// The producer never touches the disk. It only waits when the ring is full
+// (back-pressure: memory stays bounded at nSlots records), and stalls()
+// counts how often that happened.
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "ColumnFile.hh"
+
+// ---------------------------------------------------------------------------
+
+// Bounded ring of fixed-size slots for exactly one producer thread and one
+// consumer thread. head_ and tail_ only grow; each side caches the other's
+// index so the shared cache lines are only read when the cache runs out.
+class SpscRing {
+public:
+  // nSlots is rounded up to a power of two
+  SpscRing(std::size_t slotSize, std::size_t nSlots) : slotSize_(slotSize) {
+    std::size_t n = 1;
+    while (n < nSlots) n <<= 1;
+    mask_ = n - 1;
+    data_.reset(new char[slotSize_ * n]);
+  }
+
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+  std::size_t capacity() const { return mask_ + 1; }
+
+  // Producer: the next free slot, or nullptr when the ring is full
+  void* tryAcquire() {
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head - cachedTail_ > mask_) {
+      cachedTail_ = tail_.load(std::memory_order_acquire);
+      if (head - cachedTail_ > mask_) return nullptr;
+    }
+    return data_.get() + (head & mask_) * slotSize_;
+  }
+
+  // Producer: hand the acquired slot to the consumer
+  void publish() { head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  // Consumer: number of slots ready to read
+  std::size_t available() {
+    cachedHead_ = head_.load(std::memory_order_acquire);
+    return cachedHead_ - tail_.load(std::memory_order_relaxed);
+  }
+
+  // Consumer: the k-th ready slot, k < available()
+  const void* at(std::size_t k) const {
+    return data_.get() + ((tail_.load(std::memory_order_relaxed) + k) & mask_) * slotSize_;
+  }
+
+  // Consumer: free the n oldest slots
+  void release(std::size_t n) { tail_.store(tail_.load(std::memory_order_relaxed) + n, std::memory_order_release); }
+
+private:
+  std::size_t slotSize_;
+  std::size_t mask_;
+  std::unique_ptr<char[]> data_;
+
+  alignas(64) std::atomic<std::size_t> head_{0};  // written by the producer
+  std::size_t cachedTail_ = 0;
+  alignas(64) std::atomic<std::size_t> tail_{0};  // written by the consumer
+  std::size_t cachedHead_ = 0;
+};
+
+// ---------------------------------------------------------------------------
+
+class AsyncColumnWriter {
+public:
+  // ringSlots records of the widest table are buffered at most
+  explicit AsyncColumnWriter(std::size_t ringSlots = 1 << 15) : ringSlots_(ringSlots) {}
+
+  ~AsyncColumnWriter() {
+    try { close(); } catch (...) {}
+  }
+
+  AsyncColumnWriter(const AsyncColumnWriter&) = delete;
+  AsyncColumnWriter& operator=(const AsyncColumnWriter&) = delete;
+
+  // Before start(): one PHXC file per table, numeric columns only. A
+  // non-zero resumeAt appends to an existing file from that offset (see
+  // ColumnWriter::resume). Returns the table index used by fill() and addRow().
+  std::size_t addTable(const std::string& path, std::vector<ColumnSpec> schema,
+                       std::uint64_t resumeAt = 0) {
+    if (thread_.joinable()) throw std::runtime_error("AsyncColumnWriter: addTable after start");
+    Table t;
+    std::size_t width = 0;
+    for (const auto& c : schema) {
+      std::size_t w = columnTypeSize(c.type);
+      if (!w) throw std::runtime_error("AsyncColumnWriter: string column " + c.name);
+      t.offsets.push_back(width);
+      width += w;
+    }
+    t.staging.assign(width, 0);
+    if (resumeAt) t.writer = ColumnWriter::resume(path, std::move(schema), resumeAt);
+    else          t.writer.reset(new ColumnWriter(path, std::move(schema)));
+    tables_.push_back(std::move(t));
+    return tables_.size() - 1;
+  }
+
+  // Starts the writer thread
+  void start() {
+    std::size_t width = 0;
+    for (const auto& t : tables_) width = std::max(width, t.staging.size());
+    slotSize_ = (kHeader + width + 7) & ~std::size_t(7);
+    ring_.reset(new SpscRing(slotSize_, ringSlots_));
+    fileOffsets_.assign(tables_.size(), 0);
+    stop_.store(false);
+    thread_ = std::thread([this] { run(); });
+  }
+
+  // Numeric fill of the current row of a table; T must match the column type
+  template <typename T>
+  void fill(std::size_t table, std::size_t col, T value) {
+    static_assert(std::is_arithmetic<T>::value, "numeric columns only");
+    std::memcpy(tables_[table].staging.data() + tables_[table].offsets[col], &value, sizeof(T));
+  }
+
+  // Queues the staged row; waits only while the ring is full
+  void addRow(std::size_t table) {
+    void* slot = ring_->tryAcquire();
+    if (!slot) {
+      ++stalls_;
+      while (!(slot = ring_->tryAcquire())) std::this_thread::yield();
+    }
+    const auto& staging = tables_[table].staging;
+    std::uint32_t id = static_cast<std::uint32_t>(table);
+    std::memcpy(slot, &id, sizeof(id));
+    std::memcpy(static_cast<char*>(slot) + kHeader, staging.data(), staging.size());
+    ring_->publish();
+    ++rows_;
+  }
+
+  // Waits until every row queued so far is written and the files are
+  // flushed (ColumnWriter::flush); returns the file size of each table
+  std::vector<std::uint64_t> flush() {
+    if (!thread_.joinable()) throw std::runtime_error("AsyncColumnWriter: flush before start");
+    std::uint64_t ticket = flushRequested_.load(std::memory_order_relaxed) + 1;
+    flushRequested_.store(ticket, std::memory_order_release);
+    while (flushDone_.load(std::memory_order_acquire) != ticket) std::this_thread::yield();
+    if (error_) std::rethrow_exception(error_);
+    return fileOffsets_;
+  }
+
+  // Drains the ring, stops the thread and closes the files. Rethrows a
+  // write error from the writer thread.
+  void close() {
+    if (thread_.joinable()) {
+      stop_.store(true, std::memory_order_release);
+      thread_.join();
+    }
+    for (auto& t : tables_) if (t.writer) t.writer->close();
+    tables_.clear();
+    if (error_) {
+      std::exception_ptr e = error_;
+      error_ = nullptr;
+      std::rethrow_exception(e);
+    }
+  }
+
+  std::uint64_t rows() const { return rows_; }
+  std::uint64_t stalls() const { return stalls_; }
+  std::size_t   capacity() const { return ring_ ? ring_->capacity() : 0; }
+
+private:
+  static constexpr std::size_t kHeader = 8;  // u32 table index, padded
+
+  struct Table {
+    std::unique_ptr<ColumnWriter> writer;
+    std::vector<std::size_t>      offsets;  // of each column in the record
+    std::vector<char>             staging;  // producer-side current row
+  };
+
+  std::size_t ringSlots_;
+  std::size_t slotSize_ = 0;
+  std::vector<Table> tables_;
+  std::unique_ptr<SpscRing> ring_;
+  std::thread thread_;
+  std::atomic<bool> stop_{false};
+  // flush(): the producer bumps the request, the writer thread answers
+  // with the same ticket once the ring is empty and fileOffsets_ is set
+  std::atomic<std::uint64_t> flushRequested_{0}, flushDone_{0};
+  std::vector<std::uint64_t> fileOffsets_;
+  std::exception_ptr error_;
+  std::uint64_t rows_ = 0, stalls_ = 0;  // producer side
+
+  // Writer thread: decode records into the column writers until stopped
+  // and empty. Idles with yields, then short sleeps.
+  void run() {
+    try {
+      int idle = 0;
+      for (;;) {
+        // Read the flag first: every row queued before it was set is then
+        // seen by the drain below
+        bool stopping = stop_.load(std::memory_order_acquire);
+        std::uint64_t request = flushRequested_.load(std::memory_order_acquire);
+        // Bounded batches give the producer its slots back early
+        std::size_t n = std::min<std::size_t>(ring_->available(), 1024);
+        for (std::size_t k = 0; k < n; ++k) {
+          const char* rec = static_cast<const char*>(ring_->at(k));
+          std::uint32_t id;
+          std::memcpy(&id, rec, sizeof(id));
+          Table& t = tables_[id];
+          for (std::size_t c = 0; c < t.offsets.size(); ++c)
+            t.writer->fillRaw(c, rec + kHeader + t.offsets[c]);
+          t.writer->addRow();
+        }
+        if (n) {
+          ring_->release(n);
+          idle = 0;
+          continue;
+        }
+        if (request != flushDone_.load(std::memory_order_relaxed)) {
+          for (std::size_t i = 0; i < tables_.size(); ++i) fileOffsets_[i] = tables_[i].writer->flush();
+          flushDone_.store(request, std::memory_order_release);
+          continue;
+        }
+        if (stopping) break;
+        if (++idle < 64) std::this_thread::yield();
+        else std::this_thread::sleep_for(std::chrono::microseconds(200));
+      }
+    } catch (...) {
+      error_ = std::current_exception();
+      // Keep draining and answering flushes so the producer cannot wait
+      // forever
+      while (!stop_.load(std::memory_order_acquire) || ring_->available()) {
+        flushDone_.store(flushRequested_.load(std::memory_order_acquire), std::memory_order_release);
+        std::size_t n = ring_->available();
+        if (n) ring_->release(n);
+        else std::this_thread::yield();
+      }
+    }
+  }
+};
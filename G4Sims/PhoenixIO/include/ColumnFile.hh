@@ -0,0 +1,498 @@
+// ColumnFile.hh
+//
+// Compact binary, column-oriented table format ("PHXC") used for the hit
+// output of the G4 simulations, with a writer and a reader.
+//
+// Layout (native little-endian):
+//   header : "PHXC" | u32 version | u32 nColumns
+//            per column: u8 type | u16 nameLength | name bytes
+//   blocks : "BLK1" | u32 nRows | u64 nBytes per column
+//            column payloads, in schema order
+//
+// Numeric columns are stored as nRows fixed-width values. String columns
+// store nRows u32 lengths followed by the concatenated characters.
+// Blocks are independent, so files with the same schema can be merged by
+// appending their blocks, and a reader can seek straight to the columns
+// it needs.
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <sys/types.h>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+enum class ColumnType : std::uint8_t {
+  Int8 = 1, Int16, Int32, Int64, Float32, Float64, String
+};
+
+struct ColumnSpec {
+  std::string name;
+  ColumnType  type;
+};
+
+inline std::size_t columnTypeSize(ColumnType t) {
+  switch (t) {
+    case ColumnType::Int8:    return 1;
+    case ColumnType::Int16:   return 2;
+    case ColumnType::Int32:   return 4;
+    case ColumnType::Int64:   return 8;
+    case ColumnType::Float32: return 4;
+    case ColumnType::Float64: return 8;
+    case ColumnType::String:  return 0;
+  }
+  return 0;
+}
+
+template <typename T> constexpr ColumnType columnTypeOf();
+template <> constexpr ColumnType columnTypeOf<std::int8_t>()  { return ColumnType::Int8; }
+template <> constexpr ColumnType columnTypeOf<std::int16_t>() { return ColumnType::Int16; }
+template <> constexpr ColumnType columnTypeOf<std::int32_t>() { return ColumnType::Int32; }
+template <> constexpr ColumnType columnTypeOf<std::int64_t>() { return ColumnType::Int64; }
+template <> constexpr ColumnType columnTypeOf<float>()        { return ColumnType::Float32; }
+template <> constexpr ColumnType columnTypeOf<double>()       { return ColumnType::Float64; }
+
+namespace columnfile {
+  constexpr char          kFileMagic[4]  = {'P','H','X','C'};
+  constexpr char          kBlockMagic[4] = {'B','L','K','1'};
+  constexpr std::uint32_t kVersion       = 1;
+}
+
+// ---------------------------------------------------------------------------
+
+class ColumnWriter {
+public:
+  // Rows are buffered column-wise and written as one block every blockRows
+  ColumnWriter(const std::string& path, std::vector<ColumnSpec> schema,
+               std::uint32_t blockRows = 65536)
+  : schema_(std::move(schema)), blockRows_(blockRows), buffers_(schema_.size()) {
+    if (schema_.empty()) throw std::runtime_error("ColumnWriter: empty schema");
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) throw std::runtime_error("ColumnWriter: cannot open " + path);
+    allocate();
+    std::vector<char> header = headerBytes();
+    write(header.data(), header.size());
+  }
+
+  // Reopens a file written with the same schema, cuts it back to offset
+  // (a value returned by flush()) and appends from there
+  static std::unique_ptr<ColumnWriter> resume(const std::string& path, std::vector<ColumnSpec> schema,
+                                              std::uint64_t offset, std::uint32_t blockRows = 65536) {
+    return std::unique_ptr<ColumnWriter>(new ColumnWriter(path, std::move(schema), offset, blockRows));
+  }
+
+  // Errors are lost here: call close() to see them
+  ~ColumnWriter() {
+    try { close(); } catch (...) {}
+  }
+
+  ColumnWriter(const ColumnWriter&) = delete;
+  ColumnWriter& operator=(const ColumnWriter&) = delete;
+
+  std::size_t numColumns() const { return schema_.size(); }
+  const std::vector<ColumnSpec>& schema() const { return schema_; }
+
+  // Numeric fill of the current row; T must match the column type exactly
+  template <typename T>
+  void fill(std::size_t col, T value) {
+    static_assert(std::is_arithmetic<T>::value, "numeric columns only");
+    std::memcpy(buffers_[col].data() + sizeof(T) * rows_, &value, sizeof(T));
+  }
+
+  // Same from the raw bytes of a numeric value of the column's type
+  void fillRaw(std::size_t col, const void* value) {
+    std::size_t width = columnTypeSize(schema_[col].type);
+    std::memcpy(buffers_[col].data() + width * rows_, value, width);
+  }
+
+  void fillString(std::size_t col, const char* s, std::uint32_t len) {
+    append(stringLengths(col), &len, sizeof(len));
+    append(buffers_[col], s, len);
+  }
+  void fillString(std::size_t col, const std::string& s) {
+    fillString(col, s.data(), static_cast<std::uint32_t>(s.size()));
+  }
+
+  void addRow() {
+    if (++rows_ == blockRows_) flushBlock();
+  }
+
+  // Writes the pending rows as a block and pushes the file to disk.
+  // Returns the file size, i.e. the end of the last complete block.
+  std::uint64_t flush() {
+    flushBlock();
+    if (std::fflush(file_) != 0 || ::fsync(::fileno(file_)) != 0)
+      throw std::runtime_error("ColumnWriter: flush failed");
+    return static_cast<std::uint64_t>(ftello(file_));
+  }
+
+  // The file is closed even when writing the last block fails
+  void close() {
+    if (!file_) return;
+    try {
+      flushBlock();
+    } catch (...) {
+      std::fclose(file_);
+      file_ = nullptr;
+      throw;
+    }
+    int status = std::fclose(file_);
+    file_ = nullptr;
+    if (status != 0) throw std::runtime_error("ColumnWriter: close failed");
+  }
+
+private:
+  std::vector<ColumnSpec> schema_;
+  std::uint32_t blockRows_;
+  std::uint32_t rows_ = 0;
+  std::FILE* file_ = nullptr;
+  std::vector<std::vector<char>> buffers_;
+  std::vector<std::pair<std::size_t, std::vector<char>>> lengths_; // string columns only
+
+  ColumnWriter(const std::string& path, std::vector<ColumnSpec> schema,
+               std::uint64_t offset, std::uint32_t blockRows)
+  : schema_(std::move(schema)), blockRows_(blockRows), buffers_(schema_.size()) {
+    if (schema_.empty()) throw std::runtime_error("ColumnWriter: empty schema");
+    std::vector<char> header = headerBytes(), found(header.size());
+    file_ = std::fopen(path.c_str(), "r+b");
+    if (!file_) throw std::runtime_error("ColumnWriter: cannot reopen " + path);
+    bool same = std::fread(found.data(), 1, found.size(), file_) == found.size() && found == header;
+    if (!same || offset < header.size() || std::fseek(file_, 0, SEEK_END) != 0 ||
+        static_cast<std::uint64_t>(ftello(file_)) < offset ||
+        ::ftruncate(::fileno(file_), static_cast<off_t>(offset)) != 0 ||
+        fseeko(file_, static_cast<off_t>(offset), SEEK_SET) != 0) {
+      std::fclose(file_);
+      file_ = nullptr;
+      throw std::runtime_error("ColumnWriter: cannot resume " + path + " at " + std::to_string(offset));
+    }
+    allocate();
+  }
+
+  void allocate() {
+    std::setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+
+    // Fixed-width columns get their whole block up front and are filled in
+    // place, so filling a row never allocates
+    for (std::size_t c = 0; c < schema_.size(); ++c) {
+      std::size_t width = columnTypeSize(schema_[c].type);
+      if (width) buffers_[c].resize(width * blockRows_);
+      else {
+        buffers_[c].reserve(16 * blockRows_);
+        lengths_.emplace_back(c, std::vector<char>());
+      }
+    }
+  }
+
+  static void append(std::vector<char>& buf, const void* p, std::size_t n) {
+    std::size_t at = buf.size();
+    buf.resize(at + n);
+    std::memcpy(buf.data() + at, p, n);
+  }
+
+  std::vector<char>& stringLengths(std::size_t col) {
+    for (auto& l : lengths_) if (l.first == col) return l.second;
+    throw std::runtime_error("ColumnWriter: column is not a string column");
+  }
+
+  std::uint64_t payloadSize(std::size_t c) {
+    std::size_t width = columnTypeSize(schema_[c].type);
+    if (width) return width * rows_;
+    return stringLengths(c).size() + buffers_[c].size();
+  }
+
+  void write(const void* p, std::size_t n) {
+    if (n && std::fwrite(p, 1, n, file_) != n)
+      throw std::runtime_error("ColumnWriter: write failed");
+  }
+
+  std::vector<char> headerBytes() const {
+    std::vector<char> h;
+    append(h, columnfile::kFileMagic, 4);
+    append(h, &columnfile::kVersion, 4);
+    std::uint32_t n = static_cast<std::uint32_t>(schema_.size());
+    append(h, &n, 4);
+    for (const auto& c : schema_) {
+      std::uint8_t  type = static_cast<std::uint8_t>(c.type);
+      std::uint16_t len  = static_cast<std::uint16_t>(c.name.size());
+      append(h, &type, 1);
+      append(h, &len, 2);
+      append(h, c.name.data(), len);
+    }
+    return h;
+  }
+
+  void flushBlock() {
+    if (rows_ == 0) return;
+    write(columnfile::kBlockMagic, 4);
+    write(&rows_, 4);
+    for (std::size_t c = 0; c < schema_.size(); ++c) {
+      std::uint64_t nBytes = payloadSize(c);
+      write(&nBytes, 8);
+    }
+    for (std::size_t c = 0; c < schema_.size(); ++c) {
+      std::size_t width = columnTypeSize(schema_[c].type);
+      if (width) {
+        write(buffers_[c].data(), width * rows_);
+        continue;
+      }
+      auto& lens = stringLengths(c);
+      write(lens.data(), lens.size());
+      write(buffers_[c].data(), buffers_[c].size());
+      lens.clear();
+      buffers_[c].clear();
+    }
+    rows_ = 0;
+  }
+};
+
+// ---------------------------------------------------------------------------
+
+class ColumnReader {
+public:
+  explicit ColumnReader(const std::string& path) {
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) throw std::runtime_error("ColumnReader: cannot open " + path);
+    readHeader();
+    indexBlocks();
+  }
+
+  ~ColumnReader() { if (file_) std::fclose(file_); }
+
+  ColumnReader(const ColumnReader&) = delete;
+  ColumnReader& operator=(const ColumnReader&) = delete;
+
+  const std::vector<ColumnSpec>& schema() const { return schema_; }
+  std::uint64_t numRows() const { return rows_; }
+
+  // Index of a named column, or -1 if absent
+  int columnIndex(const std::string& name) const {
+    for (std::size_t c = 0; c < schema_.size(); ++c)
+      if (schema_[c].name == name) return static_cast<int>(c);
+    return -1;
+  }
+
+  // Load one numeric column; only that column's payload is read from disk
+  template <typename T>
+  std::vector<T> column(const std::string& name) {
+    std::size_t c = require(name);
+    if (schema_[c].type != columnTypeOf<T>())
+      throw std::runtime_error("ColumnReader: type mismatch for column " + name);
+    std::vector<T> out(rows_);
+    std::size_t at = 0;
+    for (const auto& b : blocks_) {
+      seek(b.offsets[c]);
+      read(out.data() + at, sizeof(T) * b.rows);
+      at += b.rows;
+    }
+    return out;
+  }
+
+  // Load any numeric column converted to double
+  std::vector<double> columnAsDouble(const std::string& name) {
+    std::size_t c = require(name);
+    switch (schema_[c].type) {
+      case ColumnType::Int8:    return convert<std::int8_t>(name);
+      case ColumnType::Int16:   return convert<std::int16_t>(name);
+      case ColumnType::Int32:   return convert<std::int32_t>(name);
+      case ColumnType::Int64:   return convert<std::int64_t>(name);
+      case ColumnType::Float32: return convert<float>(name);
+      case ColumnType::Float64: return column<double>(name);
+      case ColumnType::String:  break;
+    }
+    throw std::runtime_error("ColumnReader: column " + name + " is not numeric");
+  }
+
+  std::vector<std::string> stringColumn(const std::string& name) {
+    std::size_t c = require(name);
+    if (schema_[c].type != ColumnType::String)
+      throw std::runtime_error("ColumnReader: column " + name + " is not a string column");
+    std::vector<std::string> out;
+    out.reserve(rows_);
+    std::vector<std::uint32_t> lens;
+    std::vector<char> chars;
+    for (const auto& b : blocks_) {
+      seek(b.offsets[c]);
+      lens.resize(b.rows);
+      read(lens.data(), 4 * b.rows);
+      chars.resize(b.sizes[c] - 4 * b.rows);
+      read(chars.data(), chars.size());
+      std::size_t at = 0;
+      for (auto l : lens) { out.emplace_back(chars.data() + at, l); at += l; }
+    }
+    return out;
+  }
+
+  // Block-wise access, for tools that stream tables larger than memory
+  std::size_t   numBlocks() const { return blocks_.size(); }
+  std::uint32_t blockRows(std::size_t b) const { return blocks_[b].rows; }
+
+  // Rows [first, first + n) of numeric column c in block b, appended to out
+  // as raw values
+  void readRaw(std::size_t b, std::size_t c, std::uint32_t first, std::uint32_t n, std::vector<char>& out) {
+    std::size_t width = columnTypeSize(schema_[c].type);
+    if (!width) throw std::runtime_error("ColumnReader: column " + schema_[c].name + " is not numeric");
+    std::size_t at = out.size();
+    out.resize(at + width * n);
+    seek(blocks_[b].offsets[c] + width * first);
+    read(out.data() + at, width * n);
+  }
+
+  // Rows [first, first + n) of string column c in block b, appended to out
+  void readStrings(std::size_t b, std::size_t c, std::uint32_t first, std::uint32_t n,
+                   std::vector<std::string>& out) {
+    const Block& blk = blocks_[b];
+    std::vector<std::uint32_t> lens(blk.rows);
+    seek(blk.offsets[c]);
+    read(lens.data(), 4 * blk.rows);
+    std::uint64_t skip = 0, size = 0;
+    for (std::uint32_t r = 0; r < first; ++r) skip += lens[r];
+    for (std::uint32_t r = first; r < first + n; ++r) size += lens[r];
+    std::vector<char> chars(size);
+    seek(blk.offsets[c] + 4 * std::uint64_t(blk.rows) + skip);
+    read(chars.data(), size);
+    std::size_t at = 0;
+    for (std::uint32_t r = first; r < first + n; ++r) { out.emplace_back(chars.data() + at, lens[r]); at += lens[r]; }
+  }
+
+private:
+  struct Block {
+    std::uint32_t rows;
+    std::vector<std::uint64_t> offsets, sizes;
+  };
+
+  std::FILE* file_ = nullptr;
+  std::vector<ColumnSpec> schema_;
+  std::vector<Block> blocks_;
+  std::uint64_t rows_ = 0;
+
+  std::size_t require(const std::string& name) const {
+    int c = columnIndex(name);
+    if (c < 0) throw std::runtime_error("ColumnReader: no column " + name);
+    return static_cast<std::size_t>(c);
+  }
+
+  template <typename T>
+  std::vector<double> convert(const std::string& name) {
+    auto raw = column<T>(name);
+    return std::vector<double>(raw.begin(), raw.end());
+  }
+
+  void read(void* p, std::size_t n) {
+    if (n && std::fread(p, 1, n, file_) != n)
+      throw std::runtime_error("ColumnReader: truncated file");
+  }
+
+  void seek(std::uint64_t pos) {
+    if (fseeko(file_, static_cast<off_t>(pos), SEEK_SET) != 0)
+      throw std::runtime_error("ColumnReader: seek failed");
+  }
+
+  void readHeader() {
+    char magic[4];
+    std::uint32_t version = 0, n = 0;
+    read(magic, 4);
+    if (std::memcmp(magic, columnfile::kFileMagic, 4) != 0)
+      throw std::runtime_error("ColumnReader: not a PHXC file");
+    read(&version, 4);
+    if (version != columnfile::kVersion)
+      throw std::runtime_error("ColumnReader: unsupported version");
+    read(&n, 4);
+    for (std::uint32_t c = 0; c < n; ++c) {
+      std::uint8_t type;
+      std::uint16_t len;
+      read(&type, 1);
+      read(&len, 2);
+      std::string name(len, '\0');
+      read(&name[0], len);
+      schema_.push_back({name, static_cast<ColumnType>(type)});
+    }
+  }
+
+  void indexBlocks() {
+    const std::size_t nCols = schema_.size();
+    std::uint64_t pos = static_cast<std::uint64_t>(ftello(file_));
+    char magic[4];
+    while (std::fread(magic, 1, 4, file_) == 4) {
+      if (std::memcmp(magic, columnfile::kBlockMagic, 4) != 0)
+        throw std::runtime_error("ColumnReader: corrupt block header");
+      Block b;
+      read(&b.rows, 4);
+      b.sizes.resize(nCols);
+      read(b.sizes.data(), 8 * nCols);
+      pos += 8 + 8 * nCols;
+      b.offsets.resize(nCols);
+      for (std::size_t c = 0; c < nCols; ++c) { b.offsets[c] = pos; pos += b.sizes[c]; }
+      rows_ += b.rows;
+      blocks_.push_back(std::move(b));
+      seek(pos);
+    }
+  }
+};
+
+// ---------------------------------------------------------------------------
+
+// Append the blocks of every part to target. All parts must share the
+// schema of the first readable part; missing parts are skipped, and false
+// is returned when none exists. Throws on a part that is not a complete
+// PHXC header of this version, on a schema mismatch, when target cannot be
+// opened and on any read or write error, so that a full disk or a damaged
+// part never leaves a silently truncated target and the caller knows to
+// keep the parts.
+inline bool mergeColumnFiles(const std::string& target, const std::vector<std::string>& parts) {
+  std::FILE* out = nullptr;
+  std::vector<char> header, buf(1 << 20);
+  auto fail = [&out, &target](std::FILE* in, const std::string& what) {
+    if (in) std::fclose(in);
+    if (out) std::fclose(out);
+    throw std::runtime_error("mergeColumnFiles: " + what + " (" + target + ")");
+  };
+  auto put = [&](std::FILE* in, const char* p, std::size_t n) {
+    if (std::fwrite(p, 1, n, out) != n) fail(in, "write failed");
+  };
+  for (const auto& part : parts) {
+    std::FILE* in = std::fopen(part.c_str(), "rb");
+    if (!in) continue;
+
+    // Header length: 12 bytes + per-column descriptors
+    std::vector<char> h(12);
+    if (std::fread(h.data(), 1, 12, in) != 12) fail(in, "truncated header in " + part);
+    if (std::memcmp(h.data(), columnfile::kFileMagic, 4) != 0) fail(in, "not a PHXC file: " + part);
+    std::uint32_t version, n;
+    std::memcpy(&version, h.data() + 4, 4);
+    if (version != columnfile::kVersion) fail(in, "unsupported version in " + part);
+    std::memcpy(&n, h.data() + 8, 4);
+    for (std::uint32_t c = 0; c < n; ++c) {
+      char d[3];
+      if (std::fread(d, 1, 3, in) != 3) fail(in, "truncated header in " + part);
+      std::uint16_t len;
+      std::memcpy(&len, d + 1, 2);
+      std::size_t at = h.size();
+      h.insert(h.end(), d, d + 3);
+      h.resize(at + 3 + len);
+      if (std::fread(h.data() + at + 3, 1, len, in) != len) fail(in, "truncated header in " + part);
+    }
+
+    if (!out) {
+      out = std::fopen(target.c_str(), "wb");
+      if (!out) fail(in, "cannot open target");
+      header = h;
+      put(in, header.data(), header.size());
+    } else if (h != header) {
+      fail(in, "schema mismatch in " + part);
+    }
+
+    std::size_t got;
+    while ((got = std::fread(buf.data(), 1, buf.size(), in)) > 0) put(in, buf.data(), got);
+    if (std::ferror(in)) fail(in, "read failed in " + part);
+    std::fclose(in);
+  }
+  if (!out) return false;
+  int status = std::fclose(out);
+  out = nullptr;
+  if (status != 0) fail(nullptr, "close failed");
+  return true;
+}
@@ -0,0 +1,525 @@
+// HitHistogram.hh
+//
+// Reduces hit tables to the summaries the notebooks plot, without loading
+// them: a deposit spectrum per detector copy, and hit counts and deposit
+// sums per particle (PDG code) and per process.
+//
+// Files are memory-mapped and cut into independent pieces - a block of a
+// PHXC file, or a stretch of whole lines of a Geant4 CSV ntuple - that
+// worker threads reduce into their own HitSummary. Only the columns used
+// are decoded, and the partial summaries are added at the end.
+//
+// PHXC files store process codes; their names come from the code,name
+// table the run writes next to them (output<run>_processes.csv), or from
+// HitHistogrammer::setProcessTable. CSV ntuples store the names.
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+#include "ColumnFile.hh"
+
+// Read-only memory map of a whole file
+class MappedFile {
+public:
+  explicit MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("MappedFile: cannot open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      throw std::runtime_error("MappedFile: cannot stat " + path);
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_) {
+      void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("MappedFile: cannot map " + path);
+      }
+      ::madvise(p, size_, MADV_SEQUENTIAL);
+      data_ = static_cast<const char*>(p);
+    }
+    ::close(fd);
+  }
+
+  ~MappedFile() { if (data_) ::munmap(const_cast<char*>(data_), size_); }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+private:
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+// ---------------------------------------------------------------------------
+
+struct HitTally {
+  std::uint64_t hits = 0;
+  double        weight = 0.;  // sum of weights; hits when unweighted
+  double        edep = 0.;    // sum of weight * deposit
+
+  void add(double w, double e) { ++hits; weight += w; edep += w * e; }
+  void add(const HitTally& o) { hits += o.hits; weight += o.weight; edep += o.edep; }
+};
+
+struct CopySpectrum {
+  std::vector<double> counts, sumw2;  // per bin: sum of w, sum of w^2
+  double        underflow = 0., overflow = 0.;
+  std::uint64_t zero = 0;             // hits without deposit, not histogrammed
+  HitTally      total;                // every hit of the copy
+};
+
+struct HitSummary {
+  std::uint64_t rows = 0;
+  std::map<std::int64_t, CopySpectrum> copies;
+  std::map<std::int64_t, HitTally>     pdg;
+  std::map<std::string, HitTally, std::less<>> processes;
+
+  void add(const HitSummary& o) {
+    rows += o.rows;
+    for (const auto& [copy, s] : o.copies) {
+      CopySpectrum& t = copies[copy];
+      if (t.counts.empty()) { t.counts.assign(s.counts.size(), 0.); t.sumw2.assign(s.sumw2.size(), 0.); }
+      for (std::size_t b = 0; b < s.counts.size(); ++b) { t.counts[b] += s.counts[b]; t.sumw2[b] += s.sumw2[b]; }
+      t.underflow += s.underflow;
+      t.overflow  += s.overflow;
+      t.zero      += s.zero;
+      t.total.add(s.total);
+    }
+    for (const auto& [code, t] : o.pdg) pdg[code].add(t);
+    for (const auto& [name, t] : o.processes) processes[name].add(t);
+  }
+};
+
+// Deposit axis: bins equal in E, or in log E
+struct EdepAxis {
+  std::size_t bins = 1000;
+  double      low = 0., high = 10.;  // MeV, the Geant4 unit of the tables
+  bool        log = false;
+
+  double edge(std::size_t b) const {
+    double f = static_cast<double>(b) / static_cast<double>(bins);
+    return log ? low * std::pow(high / low, f) : low + (high - low) * f;
+  }
+};
+
+// ---------------------------------------------------------------------------
+
+class HitHistogrammer {
+public:
+  struct Columns {
+    std::string edep    = "fEdep";
+    std::string copy    = "Copy";
+    std::string pdg     = "fPDG";       // optional in the table
+    std::string process = "fPostProc";  // optional in the table
+    std::string weight;                 // none: every hit counts 1
+  };
+
+  HitHistogrammer(EdepAxis axis, Columns columns, unsigned threads = 0)
+  : axis_(axis), columns_(std::move(columns)),
+    threads_(threads ? threads : std::max(1u, std::thread::hardware_concurrency())) {
+    if (axis_.bins == 0 || !(axis_.high > axis_.low) || (axis_.log && axis_.low <= 0.))
+      throw std::runtime_error("HitHistogrammer: bad deposit axis");
+  }
+
+  // code,name table for the process codes of every PHXC input, instead of
+  // the one found next to each file
+  void setProcessTable(const std::string& path) { processTable_ = readProcessTable(path); hasTable_ = true; }
+
+  // Maps and indexes a file; its pieces are reduced by run()
+  void add(const std::string& path) {
+    auto in = std::make_unique<Input>();
+    in->path = path;
+    in->file = std::make_unique<MappedFile>(path);
+    const char* d = in->file->data();
+    if (in->file->size() >= 4 && std::memcmp(d, columnfile::kFileMagic, 4) == 0) indexPhx(*in);
+    else indexCsv(*in);
+    inputs_.push_back(std::move(in));
+  }
+
+  HitSummary run() {
+    std::vector<std::pair<std::size_t, std::size_t>> pieces;  // input, piece
+    for (std::size_t i = 0; i < inputs_.size(); ++i)
+      for (std::size_t p = 0; p < inputs_[i]->pieces.size(); ++p) pieces.emplace_back(i, p);
+
+    std::size_t nThreads = std::min<std::size_t>(threads_, std::max<std::size_t>(1, pieces.size()));
+    std::vector<HitSummary> partial(nThreads);
+    std::vector<std::string> errors(nThreads);
+    std::atomic<std::size_t> next{0};
+    auto work = [&](std::size_t t) {
+      try {
+        for (std::size_t k; (k = next.fetch_add(1)) < pieces.size();) {
+          const Input& in = *inputs_[pieces[k].first];
+          if (in.csv) reduceCsv(in, in.pieces[pieces[k].second], partial[t]);
+          else        reducePhx(in, in.pieces[pieces[k].second], partial[t]);
+        }
+      } catch (const std::exception& e) {
+        errors[t] = e.what();
+        next = pieces.size();
+      }
+    };
+    std::vector<std::thread> pool;
+    for (std::size_t t = 1; t < nThreads; ++t) pool.emplace_back(work, t);
+    work(0);
+    for (auto& th : pool) th.join();
+    for (const auto& e : errors) if (!e.empty()) throw std::runtime_error(e);
+
+    HitSummary sum;
+    for (const auto& p : partial) sum.add(p);
+    return sum;
+  }
+
+  const EdepAxis& axis() const { return axis_; }
+  std::size_t numPieces() const {
+    std::size_t n = 0;
+    for (const auto& in : inputs_) n += in->pieces.size();
+    return n;
+  }
+
+private:
+  // A PHXC block, or the CSV lines in [begin, end)
+  struct Piece {
+    std::uint64_t begin, end;
+    std::uint32_t rows;
+    std::vector<std::uint64_t> offsets;  // PHXC: column payloads
+  };
+
+  struct Input {
+    std::string path;
+    std::unique_ptr<MappedFile> file;
+    bool csv = false;
+    std::vector<ColumnSpec> schema;
+    std::vector<Piece> pieces;
+    int edep = -1, copy = -1, pdg = -1, process = -1, weight = -1;
+    std::vector<std::string> processNames;  // PHXC: by code
+  };
+
+  static constexpr std::uint64_t kCsvPiece = 8u << 20;
+
+  EdepAxis axis_;
+  Columns  columns_;
+  unsigned threads_;
+  std::vector<std::unique_ptr<Input>> inputs_;
+  std::vector<std::string> processTable_;
+  bool hasTable_ = false;
+
+  // ---- indexing ----
+
+  void resolveColumns(Input& in) const {
+    auto find = [&in](const std::string& name) {
+      if (name.empty()) return -1;
+      for (std::size_t c = 0; c < in.schema.size(); ++c)
+        if (in.schema[c].name == name) return static_cast<int>(c);
+      return -1;
+    };
+    in.edep    = find(columns_.edep);
+    in.copy    = find(columns_.copy);
+    in.pdg     = find(columns_.pdg);
+    in.process = find(columns_.process);
+    in.weight  = find(columns_.weight);
+    if (in.edep < 0 || in.copy < 0)
+      throw std::runtime_error(in.path + ": needs columns " + columns_.edep + " and " + columns_.copy);
+    if (!columns_.weight.empty() && in.weight < 0)
+      throw std::runtime_error(in.path + ": no weight column " + columns_.weight);
+    for (int c : {in.edep, in.copy, in.pdg, in.weight})
+      if (c >= 0 && in.schema[c].type == ColumnType::String)
+        throw std::runtime_error(in.path + ": column " + in.schema[c].name + " is not numeric");
+  }
+
+  void indexPhx(Input& in) const {
+    const char* d = in.file->data();
+    const std::uint64_t size = in.file->size();
+    std::uint64_t at = 4;
+    auto get = [&](void* p, std::uint64_t n) {
+      if (at + n > size) throw std::runtime_error(in.path + ": truncated PHXC file");
+      std::memcpy(p, d + at, n);
+      at += n;
+    };
+
+    std::uint32_t version = 0, n = 0;
+    get(&version, 4);
+    if (version != columnfile::kVersion) throw std::runtime_error(in.path + ": unsupported PHXC version");
+    get(&n, 4);
+    for (std::uint32_t c = 0; c < n; ++c) {
+      std::uint8_t type = 0;
+      std::uint16_t len = 0;
+      get(&type, 1);
+      get(&len, 2);
+      std::string name(len, '\0');
+      get(&name[0], len);
+      in.schema.push_back({name, static_cast<ColumnType>(type)});
+    }
+    resolveColumns(in);
+
+    while (at + 8 <= size) {
+      if (std::memcmp(d + at, columnfile::kBlockMagic, 4) != 0)
+        throw std::runtime_error(in.path + ": bad block marker");
+      Piece p;
+      p.begin = at;
+      at += 4;
+      get(&p.rows, 4);
+      std::vector<std::uint64_t> bytes(n);
+      get(bytes.data(), 8 * std::uint64_t(n));
+      for (std::uint32_t c = 0; c < n; ++c) {
+        p.offsets.push_back(at);
+        at += bytes[c];
+      }
+      if (at > size) throw std::runtime_error(in.path + ": truncated PHXC file");
+      p.end = at;
+      in.pieces.push_back(std::move(p));
+    }
+
+    if (in.process >= 0 && in.schema[in.process].type != ColumnType::String) {
+      if (hasTable_) in.processNames = processTable_;
+      else {
+        std::string table = processTablePath(in.path);
+        if (!table.empty()) in.processNames = readProcessTable(table);
+      }
+    }
+  }
+
+  void indexCsv(Input& in) const {
+    in.csv = true;
+    const char* d = in.file->data();
+    const std::uint64_t size = in.file->size();
+    std::uint64_t at = 0;
+    while (at < size && d[at] == '#') {
+      const char* eol = static_cast<const char*>(std::memchr(d + at, '\n', size - at));
+      std::uint64_t end = eol ? static_cast<std::uint64_t>(eol - d) : size;
+      std::string line(d + at, end - at);
+      if (line.compare(0, 8, "#column ") == 0) {
+        std::size_t sp = line.find(' ', 8);
+        std::string type = line.substr(8, sp - 8);
+        std::string name = sp == std::string::npos ? "" : line.substr(sp + 1);
+        while (!name.empty() && (name.back() == '\r' || name.back() == ' ')) name.pop_back();
+        in.schema.push_back({name, type == "string" ? ColumnType::String : ColumnType::Float64});
+      }
+      at = end + 1;
+    }
+    if (in.schema.empty()) throw std::runtime_error(in.path + ": neither a PHXC file nor a Geant4 CSV ntuple");
+    resolveColumns(in);
+
+    // Pieces of about kCsvPiece bytes, ending after a newline
+    while (at < size) {
+      std::uint64_t end = std::min(size, at + kCsvPiece);
+      if (end < size) {
+        const char* eol = static_cast<const char*>(std::memchr(d + end, '\n', size - end));
+        end = eol ? static_cast<std::uint64_t>(eol - d) + 1 : size;
+      }
+      in.pieces.push_back({at, end, 0, {}});
+      at = end;
+    }
+  }
+
+  // output<run>_<Table>[_t<i>].phx (AmBeCube) or run_<run>_<Table>... (CoCsCube)
+  // -> <same prefix>_processes.csv, if it exists
+  static std::string processTablePath(const std::string& path) {
+    std::size_t slash = path.find_last_of('/');
+    std::size_t start = slash == std::string::npos ? 0 : slash + 1;
+    std::size_t digits = std::string::npos;
+    for (const char* tag : {"output", "run_"}) {
+      std::size_t n = std::strlen(tag);
+      if (path.compare(start, n, tag) == 0) { digits = start + n; break; }
+    }
+    if (digits == std::string::npos) return "";
+    std::size_t under = digits;
+    while (under < path.size() && path[under] >= '0' && path[under] <= '9') ++under;
+    if (under == digits || under >= path.size() || path[under] != '_') return "";
+    std::string table = path.substr(0, under) + "_processes.csv";
+    std::ifstream probe(table);
+    return probe.is_open() ? table : "";
+  }
+
+  static std::vector<std::string> readProcessTable(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) throw std::runtime_error("cannot open process table " + path);
+    std::vector<std::string> names;
+    std::string line;
+    std::getline(in, line);  // code,name
+    while (std::getline(in, line)) {
+      std::size_t comma = line.find(',');
+      if (comma == std::string::npos) continue;
+      std::size_t code = std::stoul(line.substr(0, comma));
+      if (code >= names.size()) names.resize(code + 1);
+      names[code] = line.substr(comma + 1);
+      while (!names[code].empty() && names[code].back() == '\r') names[code].pop_back();
+    }
+    return names;
+  }
+
+  // ---- reduction ----
+
+  // The running copy, so that consecutive hits of one copy skip the lookup
+  struct CopyCache {
+    std::int64_t  copy = 0;
+    CopySpectrum* spectrum = nullptr;
+  };
+
+  void fill(HitSummary& s, CopyCache& cache, std::int64_t copy, double edep, double w) const {
+    if (!cache.spectrum || cache.copy != copy) {
+      cache.copy = copy;
+      cache.spectrum = &s.copies[copy];
+      if (cache.spectrum->counts.empty()) {
+        cache.spectrum->counts.assign(axis_.bins, 0.);
+        cache.spectrum->sumw2.assign(axis_.bins, 0.);
+      }
+    }
+    CopySpectrum& sp = *cache.spectrum;
+    sp.total.add(w, edep);
+    if (!(edep > 0.)) { ++sp.zero; return; }
+
+    double x = axis_.log ? std::log(edep / axis_.low) / std::log(axis_.high / axis_.low)
+                         : (edep - axis_.low) / (axis_.high - axis_.low);
+    if (x < 0.)       sp.underflow += w;
+    else if (x >= 1.) sp.overflow  += w;
+    else {
+      std::size_t b = std::min(axis_.bins - 1, static_cast<std::size_t>(x * static_cast<double>(axis_.bins)));
+      sp.counts[b] += w;
+      sp.sumw2[b]  += w * w;
+    }
+  }
+
+  template <typename T>
+  static void decode(const char* p, ColumnType type, std::uint32_t n, std::vector<T>& out) {
+    out.resize(n);
+    auto load = [&](auto tag) {
+      using S = decltype(tag);
+      for (std::uint32_t r = 0; r < n; ++r) {
+        S v;
+        std::memcpy(&v, p + sizeof(S) * r, sizeof(S));
+        out[r] = static_cast<T>(v);
+      }
+    };
+    switch (type) {
+      case ColumnType::Int8:    load(std::int8_t());  break;
+      case ColumnType::Int16:   load(std::int16_t()); break;
+      case ColumnType::Int32:   load(std::int32_t()); break;
+      case ColumnType::Int64:   load(std::int64_t()); break;
+      case ColumnType::Float32: load(float());        break;
+      case ColumnType::Float64: load(double());       break;
+      case ColumnType::String:  throw std::runtime_error("HitHistogrammer: string column where a number is needed");
+    }
+  }
+
+  static HitTally& tallyProcess(HitSummary& s, std::string_view name) {
+    auto it = s.processes.find(name);
+    if (it == s.processes.end()) it = s.processes.emplace(std::string(name), HitTally()).first;
+    return it->second;
+  }
+
+  void reducePhx(const Input& in, const Piece& piece, HitSummary& s) const {
+    const char* d = in.file->data();
+    const std::uint32_t n = piece.rows;
+    std::vector<double> edep, weight;
+    std::vector<std::int64_t> copy, pdg, code;
+    decode(d + piece.offsets[in.edep], in.schema[in.edep].type, n, edep);
+    decode(d + piece.offsets[in.copy], in.schema[in.copy].type, n, copy);
+    if (in.weight >= 0) decode(d + piece.offsets[in.weight], in.schema[in.weight].type, n, weight);
+    if (in.pdg >= 0)    decode(d + piece.offsets[in.pdg], in.schema[in.pdg].type, n, pdg);
+
+    // Process names: per code for a numeric column, per row for a string one
+    std::vector<std::string_view> names;
+    bool byCode = in.process >= 0 && in.schema[in.process].type != ColumnType::String;
+    if (byCode) decode(d + piece.offsets[in.process], in.schema[in.process].type, n, code);
+    else if (in.process >= 0) {
+      const char* p = d + piece.offsets[in.process];
+      const char* chars = p + 4 * std::uint64_t(n);
+      names.resize(n);
+      for (std::uint32_t r = 0; r < n; ++r) {
+        std::uint32_t len;
+        std::memcpy(&len, p + 4 * std::uint64_t(r), 4);
+        names[r] = std::string_view(chars, len);
+        chars += len;
+      }
+    }
+
+    CopyCache cache;
+    std::map<std::int64_t, HitTally> codes;
+    for (std::uint32_t r = 0; r < n; ++r) {
+      double w = in.weight >= 0 ? weight[r] : 1.;
+      fill(s, cache, copy[r], edep[r], w);
+      if (in.pdg >= 0) s.pdg[pdg[r]].add(w, edep[r]);
+      if (byCode) codes[code[r]].add(w, edep[r]);
+      else if (in.process >= 0) tallyProcess(s, names[r]).add(w, edep[r]);
+    }
+    for (const auto& [c, t] : codes) {
+      bool known = c >= 0 && static_cast<std::size_t>(c) < in.processNames.size() && !in.processNames[c].empty();
+      tallyProcess(s, known ? in.processNames[c] : std::to_string(c)).add(t);
+    }
+    s.rows += n;
+  }
+
+  void reduceCsv(const Input& in, const Piece& piece, HitSummary& s) const {
+    const char* p   = in.file->data() + piece.begin;
+    const char* end = in.file->data() + piece.end;
+    int last = std::max({in.edep, in.copy, in.pdg, in.process, in.weight});
+
+    std::vector<std::string_view> fields(last + 1);
+    CopyCache cache;
+    while (p < end) {
+      const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+      if (!eol) eol = end;
+      const char* lineEnd = (eol > p && eol[-1] == '\r') ? eol - 1 : eol;
+      if (lineEnd == p) { p = eol + 1; continue; }
+
+      // Split as far as the last column used
+      const char* f = p;
+      int k = 0;
+      for (; k <= last; ++k) {
+        const char* comma = static_cast<const char*>(std::memchr(f, ',', lineEnd - f));
+        const char* fe = comma ? comma : lineEnd;
+        fields[k] = std::string_view(f, fe - f);
+        if (!comma) { ++k; break; }
+        f = comma + 1;
+      }
+      if (k <= last) throw std::runtime_error(in.path + ": short line");
+
+      double edep = number<double>(fields[in.edep], in);
+      double w    = in.weight >= 0 ? number<double>(fields[in.weight], in) : 1.;
+      fill(s, cache, number<std::int64_t>(fields[in.copy], in), edep, w);
+      if (in.pdg >= 0)     s.pdg[number<std::int64_t>(fields[in.pdg], in)].add(w, edep);
+      if (in.process >= 0) tallyProcess(s, fields[in.process]).add(w, edep);
+      ++s.rows;
+      p = eol + 1;
+    }
+  }
+
+  template <typename T>
+  static T number(std::string_view text, const Input& in) {
+    T v{};
+    const char* b = text.data();
+    const char* e = b + text.size();
+    while (b < e && *b == ' ') ++b;
+    auto r = std::from_chars(b, e, v);
+    if (r.ec != std::errc()) {
+      // Integers written as floating point, e.g. by pandas
+      if constexpr (std::is_integral_v<T>) {
+        double x = 0.;
+        if (std::from_chars(b, e, x).ec == std::errc()) return static_cast<T>(x);
+      }
+      throw std::runtime_error(in.path + ": bad number '" + std::string(text) + "'");
+    }
+    return v;
+  }
+};
@@ -0,0 +1,86 @@
+// =========================================================================
+// Project  : PhoenixIO
+// File     : phoenix_dump.cc
+// Author   : nhargy
+// Brief    : Print the schema of a PHXC hit file, or selected columns as CSV
+// =========================================================================
+
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ColumnFile.hh"
+
+static const char* typeName(ColumnType t) {
+    switch (t) {
+        case ColumnType::Int8:    return "int8";
+        case ColumnType::Int16:   return "int16";
+        case ColumnType::Int32:   return "int32";
+        case ColumnType::Int64:   return "int64";
+        case ColumnType::Float32: return "float32";
+        case ColumnType::Float64: return "float64";
+        case ColumnType::String:  return "string";
+    }
+    return "?";
+}
+
+// Usage: phoenix_dump <file.phx> [col1,col2,...|all]
+int main(int argc, char **argv) {
+
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <file.phx> [col1,col2,...|all]" << std::endl;
+        return 1;
+    }
+
+    try {
+        ColumnReader reader(argv[1]);
+
+        if (argc == 2) {
+            std::cout << argv[1] << ": " << reader.numRows() << " rows" << std::endl;
+            for (const auto &c : reader.schema())
+                std::cout << "  " << c.name << " (" << typeName(c.type) << ")" << std::endl;
+            return 0;
+        }
+
+        std::vector<std::string> names;
+        std::string selection = argv[2];
+        if (selection == "all") {
+            for (const auto &c : reader.schema()) names.push_back(c.name);
+        } else {
+            std::stringstream ss(selection);
+            std::string name;
+            while (std::getline(ss, name, ',')) names.push_back(name);
+        }
+
+        // Only the requested columns are loaded
+        std::vector<std::vector<double>>      numeric(names.size());
+        std::vector<std::vector<std::string>> strings(names.size());
+        std::vector<bool> isString(names.size());
+        for (size_t i = 0; i < names.size(); ++i) {
+            int c = reader.columnIndex(names[i]);
+            if (c < 0) throw std::runtime_error("no column " + names[i]);
+            isString[i] = reader.schema()[c].type == ColumnType::String;
+            if (isString[i]) strings[i] = reader.stringColumn(names[i]);
+            else             numeric[i] = reader.columnAsDouble(names[i]);
+        }
+
+        for (size_t i = 0; i < names.size(); ++i) std::printf(i ? ",%s" : "%s", names[i].c_str());
+        std::printf("\n");
+        for (std::uint64_t r = 0; r < reader.numRows(); ++r) {
+            for (size_t i = 0; i < names.size(); ++i) {
+                if (i) std::putchar(',');
+                if (isString[i]) std::fputs(strings[i][r].c_str(), stdout);
+                else             std::printf("%.10g", numeric[i][r]);
+            }
+            std::putchar('\n');
+        }
+    }
+    catch (const std::exception &e) {
+        std::cerr << "phoenix_dump: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
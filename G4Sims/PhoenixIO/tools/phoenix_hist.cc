@@ -0,0 +1,124 @@
+// =========================================================================
+// Project  : PhoenixIO
+// File     : phoenix_hist.cc
+// Brief    : Deposit spectra and particle/process tallies of hit tables
+// =========================================================================
+//
+// Reduces any number of PHXC files or Geant4 CSV ntuples with the same
+// columns (HitHistogram.hh) and writes, next to <base>:
+//   <base>_spectra.csv - copy, bin, low, high, counts, sumw2: the deposit
+//                        spectrum of every copy, in MeV
+//   <base>_copies.csv  - copy, hits, weight, edep, zero, underflow, overflow
+//   <base>_pdg.csv     - pdg, hits, weight, edep
+//   <base>_procs.csv   - process, hits, weight, edep
+// weight is the sum of the hit weights (the hits when unweighted) and edep
+// the weighted deposit sum. Hits without deposit are counted in "zero" and
+// left out of the spectra.
+//
+// Usage: phoenix_hist -o <base> [-b bins] [-r low:high] [-l] [-e edepCol]
+//                     [-c copyCol] [-P processCol] [-w weightCol]
+//                     [-p processes.csv] [-j threads] <in>...
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "HitHistogram.hh"
+
+namespace {
+
+std::ofstream openOutput(const std::string& path) {
+    std::ofstream out(path);
+    if (!out.is_open()) throw std::runtime_error("cannot write " + path);
+    out.precision(17);
+    return out;
+}
+
+void writeSummary(const std::string& base, const HitSummary& sum, const EdepAxis& axis) {
+
+    std::ofstream spectra = openOutput(base + "_spectra.csv");
+    spectra << "copy,bin,low,high,counts,sumw2\n";
+    for (const auto& [copy, s] : sum.copies)
+        for (std::size_t b = 0; b < s.counts.size(); ++b)
+            spectra << copy << "," << b << "," << axis.edge(b) << "," << axis.edge(b + 1) << ","
+                    << s.counts[b] << "," << s.sumw2[b] << "\n";
+
+    std::ofstream copies = openOutput(base + "_copies.csv");
+    copies << "copy,hits,weight,edep,zero,underflow,overflow\n";
+    for (const auto& [copy, s] : sum.copies)
+        copies << copy << "," << s.total.hits << "," << s.total.weight << "," << s.total.edep << ","
+               << s.zero << "," << s.underflow << "," << s.overflow << "\n";
+
+    std::ofstream pdg = openOutput(base + "_pdg.csv");
+    pdg << "pdg,hits,weight,edep\n";
+    for (const auto& [code, t] : sum.pdg)
+        pdg << code << "," << t.hits << "," << t.weight << "," << t.edep << "\n";
+
+    std::ofstream procs = openOutput(base + "_procs.csv");
+    procs << "process,hits,weight,edep\n";
+    for (const auto& [name, t] : sum.processes)
+        procs << name << "," << t.hits << "," << t.weight << "," << t.edep << "\n";
+}
+
+}
+
+int main(int argc, char **argv) {
+
+    std::string base, processTable;
+    EdepAxis axis;
+    HitHistogrammer::Columns columns;
+    unsigned threads = 0;
+    std::vector<std::string> inputs;
+    bool ok = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool more = i + 1 < argc;
+        if      (arg == "-o" && more) base           = argv[++i];
+        else if (arg == "-b" && more) axis.bins      = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "-l")         axis.log       = true;
+        else if (arg == "-e" && more) columns.edep    = argv[++i];
+        else if (arg == "-c" && more) columns.copy    = argv[++i];
+        else if (arg == "-P" && more) columns.process = argv[++i];
+        else if (arg == "-w" && more) columns.weight  = argv[++i];
+        else if (arg == "-p" && more) processTable    = argv[++i];
+        else if (arg == "-j" && more) threads         = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "-r" && more) {
+            std::string range = argv[++i];
+            std::size_t colon = range.find(':');
+            if (colon == std::string::npos) { ok = false; break; }
+            axis.low  = std::atof(range.substr(0, colon).c_str());
+            axis.high = std::atof(range.substr(colon + 1).c_str());
+        }
+        else if (!arg.empty() && arg[0] == '-') { ok = false; break; }
+        else inputs.push_back(arg);
+    }
+    if (!ok || base.empty() || inputs.empty()) {
+        std::cerr << "Usage: " << argv[0] << " -o <base> [-b bins] [-r low:high] [-l] [-e edepCol] [-c copyCol]\n"
+                  << "       [-P processCol] [-w weightCol] [-p processes.csv] [-j threads] <in>..." << std::endl;
+        return 1;
+    }
+
+    try {
+        auto start = std::chrono::steady_clock::now();
+
+        HitHistogrammer hist(axis, columns, threads);
+        if (!processTable.empty()) hist.setProcessTable(processTable);
+        for (const auto& path : inputs) hist.add(path);
+        HitSummary sum = hist.run();
+        writeSummary(base, sum, axis);
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << base << ": " << sum.rows << " hits from " << inputs.size() << " files (" << hist.numPieces()
+                  << " pieces) in " << seconds << " s; " << sum.copies.size() << " copies, " << sum.pdg.size()
+                  << " particles, " << sum.processes.size() << " processes" << std::endl;
+    }
+    catch (const std::exception &e) {
+        std::cerr << "phoenix_hist: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
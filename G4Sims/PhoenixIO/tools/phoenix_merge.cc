@@ -0,0 +1,564 @@
+// =========================================================================
+// Project  : PhoenixIO
+// File     : phoenix_merge.cc
+// Brief    : Stream hit tables of many runs/workers into one, sorted by event
+// =========================================================================
+//
+// Inputs are PHXC files or Geant4 CSV ntuples ('#column <type> <name>'
+// header), all with the same columns. Files that differ only by a _t<i>
+// thread suffix form one source (a run); every other file is a source of
+// its own. Event IDs restart in every source, so they are renumbered:
+// source s is shifted by the number of events (largest ID + 1) of the
+// sources before it. An fSource column is added (or overwritten, when
+// merging merged files), and <out>_sources.csv maps each source to its
+// files, run number and event offset.
+//
+// Rows are never all in memory. A first pass reads only the event column
+// and cuts every file into stretches of non-decreasing event ID (one per
+// thread in an MT-merged file). Each stretch is then a sorted run of a
+// k-way merge, read through a buffer of at most budget / k bytes.
+//
+// Usage: phoenix_merge -o <out.phx|out.csv> [-e eventColumn] [-m budgetMB] <in>...
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ColumnFile.hh"
+
+namespace {
+
+bool endsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// ---- CSV ntuples ----------------------------------------------------------
+
+ColumnType csvType(const std::string& name) {
+    if (name == "double")                     return ColumnType::Float64;
+    if (name == "float")                      return ColumnType::Float32;
+    if (name == "int" || name == "uint")      return ColumnType::Int32;
+    if (name == "short" || name == "ushort")  return ColumnType::Int16;
+    if (name == "char" || name == "uchar" || name == "bool") return ColumnType::Int8;
+    if (name == "long" || name == "int64" || name == "uint64") return ColumnType::Int64;
+    if (name == "string")                     return ColumnType::String;
+    throw std::runtime_error("unsupported CSV column type " + name);
+}
+
+const char* csvTypeName(ColumnType t) {
+    switch (t) {
+        case ColumnType::Int8:    return "char";
+        case ColumnType::Int16:   return "short";
+        case ColumnType::Int32:   return "int";
+        case ColumnType::Int64:   return "int64";
+        case ColumnType::Float32: return "float";
+        case ColumnType::Float64: return "double";
+        case ColumnType::String:  return "string";
+    }
+    return "?";
+}
+
+struct CsvHeader {
+    std::vector<ColumnSpec> schema;
+    std::string   title;
+    std::uint64_t dataOffset = 0;  // first row
+};
+
+CsvHeader readCsvHeader(std::istream& in, const std::string& path) {
+    CsvHeader h;
+    std::string line;
+    while (in.peek() == '#' && std::getline(in, line)) {
+        h.dataOffset += line.size() + 1;
+        std::istringstream words(line);
+        std::string key, type, name;
+        words >> key;
+        if (key == "#column" && words >> type >> name) h.schema.push_back({name, csvType(type)});
+        else if (key == "#title") std::getline(words >> std::ws, h.title);
+    }
+    if (h.schema.empty()) throw std::runtime_error(path + ": no '#column' header (not a Geant4 CSV ntuple)");
+    return h;
+}
+
+// One field as the raw bytes of its column type
+void parseField(const char* begin, const char* end, ColumnType type, std::vector<char>& out) {
+    auto put = [&out](const auto& v) {
+        const char* p = reinterpret_cast<const char*>(&v);
+        out.insert(out.end(), p, p + sizeof(v));
+    };
+    std::string text(begin, end);
+    switch (type) {
+        case ColumnType::Int8:    put(static_cast<std::int8_t>(std::strtol(text.c_str(), nullptr, 10)));  break;
+        case ColumnType::Int16:   put(static_cast<std::int16_t>(std::strtol(text.c_str(), nullptr, 10))); break;
+        case ColumnType::Int32:   put(static_cast<std::int32_t>(std::strtol(text.c_str(), nullptr, 10))); break;
+        case ColumnType::Int64:   put(static_cast<std::int64_t>(std::strtoll(text.c_str(), nullptr, 10))); break;
+        case ColumnType::Float32: put(std::strtof(text.c_str(), nullptr)); break;
+        case ColumnType::Float64: put(std::strtod(text.c_str(), nullptr)); break;
+        case ColumnType::String:  break;
+    }
+}
+
+// Fields of a CSV line, without copying
+std::vector<std::pair<const char*, const char*>> splitLine(const std::string& line, std::size_t nFields) {
+    std::vector<std::pair<const char*, const char*>> fields;
+    fields.reserve(nFields);
+    const char* p   = line.data();
+    const char* end = p + line.size();
+    if (end > p && end[-1] == '\r') --end;
+    for (;;) {
+        const char* comma = static_cast<const char*>(std::memchr(p, ',', end - p));
+        if (!comma) { fields.emplace_back(p, end); break; }
+        fields.emplace_back(p, comma);
+        p = comma + 1;
+    }
+    return fields;
+}
+
+std::int64_t rawToInt(const char* p, ColumnType type) {
+    switch (type) {
+        case ColumnType::Int8:  { std::int8_t  v; std::memcpy(&v, p, 1); return v; }
+        case ColumnType::Int16: { std::int16_t v; std::memcpy(&v, p, 2); return v; }
+        case ColumnType::Int32: { std::int32_t v; std::memcpy(&v, p, 4); return v; }
+        case ColumnType::Int64: { std::int64_t v; std::memcpy(&v, p, 8); return v; }
+        default: break;
+    }
+    throw std::runtime_error("event column must be an integer column");
+}
+
+// Shortest text that reads back to the same value
+void formatRaw(std::string& out, const char* p, ColumnType type) {
+    char buf[64];
+    std::to_chars_result r{buf, std::errc()};
+    switch (type) {
+        case ColumnType::Float32: { float  v; std::memcpy(&v, p, 4); r = std::to_chars(buf, buf + sizeof(buf), v); break; }
+        case ColumnType::Float64: { double v; std::memcpy(&v, p, 8); r = std::to_chars(buf, buf + sizeof(buf), v); break; }
+        case ColumnType::String:  break;
+        default: r = std::to_chars(buf, buf + sizeof(buf), rawToInt(p, type)); break;
+    }
+    out.append(buf, r.ptr);
+}
+
+// ---- Inputs ---------------------------------------------------------------
+
+// A stretch of rows of one input in non-decreasing event order
+struct Segment {
+    std::size_t   input;
+    std::uint64_t firstRow;
+    std::uint64_t rows;
+    std::uint64_t csvOffset;  // CSV: byte offset of the first row
+};
+
+struct Input {
+    std::string   path;
+    bool          csv = false;
+    std::string   title;
+    std::size_t   source = 0;
+    std::int64_t  maxEvent = -1;
+    std::uint64_t rows = 0;
+    std::vector<ColumnSpec> schema;
+    std::uint64_t csvDataOffset = 0;
+};
+
+struct Source {
+    std::string key;
+    std::vector<std::string> files;
+    long          run = -1;
+    std::int64_t  maxEvent = -1;
+    std::int64_t  offset = 0;
+};
+
+// <dir>/<name> without a _t<digits> suffix before the extension: the thread
+// files of one run share it
+std::string sourceKey(const std::string& path) {
+    std::size_t dot = path.find_last_of('.');
+    std::size_t slash = path.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) dot = path.size();
+    std::size_t t = path.rfind("_t", dot);
+    if (t != std::string::npos && t + 2 < dot &&
+        std::all_of(path.begin() + t + 2, path.begin() + dot, [](char c) { return c >= '0' && c <= '9'; }))
+        return path.substr(0, t) + path.substr(dot);
+    return path;
+}
+
+// Run number from a run_<n> or output<n> file name, -1 if none
+long runNumber(const std::string& path) {
+    std::string name = path.substr(path.find_last_of('/') == std::string::npos ? 0 : path.find_last_of('/') + 1);
+    for (const char* tag : {"run_", "output"}) {
+        std::size_t at = name.find(tag);
+        if (at == std::string::npos) continue;
+        at += std::strlen(tag);
+        if (at < name.size() && name[at] >= '0' && name[at] <= '9') return std::strtol(name.c_str() + at, nullptr, 10);
+    }
+    return -1;
+}
+
+// First pass: schema, largest event ID and the sorted stretches of a file,
+// reading the event column only
+void scan(Input& in, std::size_t index, const std::string& eventName, std::vector<Segment>& segments) {
+
+    std::int64_t prev = std::numeric_limits<std::int64_t>::min();
+    std::uint64_t row = 0;
+    auto see = [&](std::int64_t event, std::uint64_t csvOffset) {
+        if (event < prev || row == 0) segments.push_back({index, row, 0, csvOffset});
+        segments.back().rows++;
+        in.maxEvent = std::max(in.maxEvent, event);
+        prev = event;
+        ++row;
+    };
+
+    if (!in.csv) {
+        ColumnReader reader(in.path);
+        in.schema = reader.schema();
+        int c = reader.columnIndex(eventName);
+        if (c < 0) throw std::runtime_error(in.path + ": no column " + eventName);
+        ColumnType type = in.schema[c].type;
+        std::size_t width = columnTypeSize(type);
+        std::vector<char> events;
+        for (std::size_t b = 0; b < reader.numBlocks(); ++b) {
+            events.clear();
+            reader.readRaw(b, c, 0, reader.blockRows(b), events);
+            for (std::uint32_t r = 0; r < reader.blockRows(b); ++r) see(rawToInt(events.data() + width * r, type), 0);
+        }
+    } else {
+        std::ifstream file(in.path, std::ios::binary);
+        if (!file.is_open()) throw std::runtime_error("cannot open " + in.path);
+        CsvHeader header = readCsvHeader(file, in.path);
+        in.schema = header.schema;
+        in.title  = header.title;
+        in.csvDataOffset = header.dataOffset;
+        std::size_t c = 0;
+        while (c < in.schema.size() && in.schema[c].name != eventName) ++c;
+        if (c == in.schema.size()) throw std::runtime_error(in.path + ": no column " + eventName);
+        ColumnType type = in.schema[c].type;
+
+        std::uint64_t offset = header.dataOffset;
+        std::string line;
+        std::vector<char> value;
+        while (std::getline(file, line)) {
+            std::uint64_t next = offset + line.size() + 1;
+            if (line.empty() || line == "\r") { offset = next; continue; }
+            auto fields = splitLine(line, in.schema.size());
+            if (fields.size() != in.schema.size())
+                throw std::runtime_error(in.path + ": row " + std::to_string(row) + " has " +
+                                         std::to_string(fields.size()) + " fields");
+            value.clear();
+            parseField(fields[c].first, fields[c].second, type, value);
+            see(rawToInt(value.data(), type), offset);
+            offset = next;
+        }
+    }
+    in.rows = row;
+}
+
+// ---- Merge ----------------------------------------------------------------
+
+// Buffered rows of a segment, column by column
+struct Chunk {
+    std::vector<std::vector<char>>        raw;  // numeric columns
+    std::vector<std::vector<std::string>> str;  // string columns
+    std::vector<std::int64_t>             event;
+    std::size_t rows = 0, pos = 0;
+};
+
+class Cursor {
+    public:
+        Cursor(const Input& in, const Segment& seg, std::size_t eventCol)
+            : in_(in), left_(seg.rows), row_(seg.firstRow), eventCol_(eventCol) {
+            const std::size_t n = in.schema.size();
+            chunk_.raw.resize(n);
+            chunk_.str.resize(n);
+            if (in.csv) {
+                file_.reset(new std::ifstream(in.path, std::ios::binary));
+                file_->seekg(static_cast<std::streamoff>(seg.csvOffset));
+            } else {
+                reader_.reset(new ColumnReader(in.path));
+                // Block holding the first row
+                while (block_ < reader_->numBlocks() && row_ >= blockStart_ + reader_->blockRows(block_))
+                    blockStart_ += reader_->blockRows(block_++);
+            }
+        }
+
+        const Input& input() const { return in_; }
+        const Chunk& chunk() const { return chunk_; }
+        std::int64_t event() const { return chunk_.event[chunk_.pos]; }
+
+        // Next row; false when the segment is exhausted
+        bool next(std::size_t maxRows) {
+            if (++chunk_.pos < chunk_.rows) return true;
+            return load(maxRows);
+        }
+
+        bool load(std::size_t maxRows) {
+            std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(left_, maxRows));
+            for (auto& r : chunk_.raw) r.clear();
+            for (auto& s : chunk_.str) s.clear();
+            chunk_.event.clear();
+            chunk_.rows = chunk_.pos = 0;
+            if (n == 0) return false;
+
+            if (in_.csv) loadCsv(n);
+            else         loadPhxc(n);
+
+            const ColumnType type = in_.schema[eventCol_].type;
+            const std::size_t width = columnTypeSize(type);
+            for (std::size_t r = 0; r < n; ++r)
+                chunk_.event.push_back(rawToInt(chunk_.raw[eventCol_].data() + width * r, type));
+            chunk_.rows = n;
+            left_ -= n;
+            row_  += n;
+            return true;
+        }
+
+    private:
+        const Input& in_;
+        std::uint64_t left_, row_;
+        std::size_t eventCol_;
+        Chunk chunk_;
+
+        std::unique_ptr<std::ifstream> file_;
+        std::unique_ptr<ColumnReader>  reader_;
+        std::size_t   block_ = 0;
+        std::uint64_t blockStart_ = 0;
+
+        void loadPhxc(std::size_t n) {
+            std::uint64_t row = row_;
+            while (n > 0) {
+                if (row >= blockStart_ + reader_->blockRows(block_)) blockStart_ += reader_->blockRows(block_++);
+                std::uint32_t first = static_cast<std::uint32_t>(row - blockStart_);
+                std::uint32_t take  = static_cast<std::uint32_t>(
+                    std::min<std::uint64_t>(n, reader_->blockRows(block_) - first));
+                for (std::size_t c = 0; c < in_.schema.size(); ++c) {
+                    if (in_.schema[c].type == ColumnType::String) reader_->readStrings(block_, c, first, take, chunk_.str[c]);
+                    else                                          reader_->readRaw(block_, c, first, take, chunk_.raw[c]);
+                }
+                row += take;
+                n   -= take;
+            }
+        }
+
+        void loadCsv(std::size_t n) {
+            std::string line;
+            while (n > 0 && std::getline(*file_, line)) {
+                if (line.empty() || line == "\r") continue;
+                auto fields = splitLine(line, in_.schema.size());
+                for (std::size_t c = 0; c < in_.schema.size(); ++c) {
+                    if (in_.schema[c].type == ColumnType::String) chunk_.str[c].emplace_back(fields[c].first, fields[c].second);
+                    else parseField(fields[c].first, fields[c].second, in_.schema[c].type, chunk_.raw[c]);
+                }
+                --n;
+            }
+            if (n > 0) throw std::runtime_error(in_.path + ": shorter than on the first pass");
+        }
+};
+
+// PHXC or CSV output with the input columns plus fSource
+class Output {
+    public:
+        Output(const std::string& path, const std::vector<ColumnSpec>& schema, std::size_t eventCol,
+               ColumnType eventType, const std::string& title)
+            : schema_(schema), eventCol_(eventCol), eventType_(eventType), csv_(endsWith(path, ".csv")) {
+            schema_[eventCol_].type = eventType_;
+            sourceCol_ = 0;
+            while (sourceCol_ < schema_.size() && schema_[sourceCol_].name != "fSource") ++sourceCol_;
+            if (sourceCol_ == schema_.size()) schema_.push_back({"fSource", ColumnType::Int32});
+            else                              schema_[sourceCol_].type = ColumnType::Int32;
+            if (!csv_) {
+                writer_.reset(new ColumnWriter(path, schema_));
+                return;
+            }
+            file_.open(path, std::ios::binary | std::ios::trunc);
+            if (!file_.is_open()) throw std::runtime_error("cannot open " + path);
+            file_ << "#class tools::wcsv::ntuple\n#title " << title
+                  << "\n#separator 44\n#vector_separator 59\n";
+            for (const auto& c : schema_) file_ << "#column " << csvTypeName(c.type) << " " << c.name << "\n";
+        }
+
+        void write(const Input& in, const Chunk& chunk, std::int64_t event, std::int32_t source) {
+            const std::size_t r = chunk.pos;
+            const std::size_t n = in.schema.size();
+            if (!csv_) {
+                for (std::size_t c = 0; c < n; ++c) {
+                    if (c == eventCol_ || c == sourceCol_) continue;
+                    if (in.schema[c].type == ColumnType::String) writer_->fillString(c, chunk.str[c][r]);
+                    else writer_->fillRaw(c, chunk.raw[c].data() + columnTypeSize(in.schema[c].type) * r);
+                }
+                if (eventType_ == ColumnType::Int64) writer_->fill<std::int64_t>(eventCol_, event);
+                else                                 writer_->fill<std::int32_t>(eventCol_, static_cast<std::int32_t>(event));
+                writer_->fill<std::int32_t>(sourceCol_, source);
+                writer_->addRow();
+                return;
+            }
+            line_.clear();
+            for (std::size_t c = 0; c < n; ++c) {
+                if (c) line_ += ',';
+                if (c == eventCol_ || c == sourceCol_) {
+                    char buf[24];
+                    std::int64_t value = (c == eventCol_) ? event : source;
+                    line_.append(buf, std::to_chars(buf, buf + sizeof(buf), value).ptr);
+                } else if (in.schema[c].type == ColumnType::String) {
+                    line_ += chunk.str[c][r];
+                } else {
+                    formatRaw(line_, chunk.raw[c].data() + columnTypeSize(in.schema[c].type) * r, in.schema[c].type);
+                }
+            }
+            if (sourceCol_ == n) {
+                line_ += ',';
+                line_ += std::to_string(source);
+            }
+            line_ += '\n';
+            file_ << line_;
+        }
+
+        void close() {
+            if (writer_) writer_->close();
+            if (file_.is_open()) file_.close();
+        }
+
+    private:
+        std::vector<ColumnSpec> schema_;
+        std::size_t eventCol_;
+        std::size_t sourceCol_;  // == input columns when appended
+        ColumnType  eventType_;
+        bool        csv_;
+        std::unique_ptr<ColumnWriter> writer_;
+        std::ofstream file_;
+        std::string   line_;
+};
+
+bool sameSchema(const std::vector<ColumnSpec>& a, const std::vector<ColumnSpec>& b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t c = 0; c < a.size(); ++c)
+        if (a[c].name != b[c].name || a[c].type != b[c].type) return false;
+    return true;
+}
+
+std::size_t rowBytes(const std::vector<ColumnSpec>& schema) {
+    std::size_t bytes = 0;
+    for (const auto& c : schema) bytes += c.type == ColumnType::String ? 48 : columnTypeSize(c.type);
+    return bytes + sizeof(std::int64_t);
+}
+
+}
+
+int main(int argc, char **argv) {
+
+    std::string outPath, eventName = "fEvent";
+    double budgetMB = 256.;
+    std::vector<Input> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if      (arg == "-o" && i + 1 < argc) outPath   = argv[++i];
+        else if (arg == "-e" && i + 1 < argc) eventName = argv[++i];
+        else if (arg == "-m" && i + 1 < argc) budgetMB  = std::atof(argv[++i]);
+        else {
+            Input in;
+            in.path = arg;
+            in.csv  = endsWith(arg, ".csv");
+            inputs.push_back(in);
+        }
+    }
+    if (outPath.empty() || inputs.empty() || budgetMB <= 0.) {
+        std::cerr << "Usage: " << argv[0] << " -o <out.phx|out.csv> [-e eventColumn] [-m budgetMB] <in>..." << std::endl;
+        return 1;
+    }
+
+    try {
+        // ---- First pass: schema, sources, sorted segments ----
+        std::vector<Segment> segments;
+        std::vector<Source>  sources;
+        std::map<std::string, std::size_t> sourceIndex;
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+            Input& in = inputs[i];
+            scan(in, i, eventName, segments);
+            if (!sameSchema(in.schema, inputs[0].schema))
+                throw std::runtime_error(in.path + ": columns differ from " + inputs[0].path);
+
+            std::string key = sourceKey(in.path);
+            auto it = sourceIndex.find(key);
+            if (it == sourceIndex.end()) {
+                it = sourceIndex.emplace(key, sources.size()).first;
+                sources.push_back({key, {}, runNumber(in.path), -1, 0});
+            }
+            in.source = it->second;
+            sources[in.source].files.push_back(in.path);
+            sources[in.source].maxEvent = std::max(sources[in.source].maxEvent, in.maxEvent);
+        }
+
+        // Each source's events follow those of the sources before it
+        std::int64_t nEvents = 0;
+        for (auto& s : sources) {
+            s.offset = nEvents;
+            nEvents += s.maxEvent + 1;
+        }
+
+        const std::vector<ColumnSpec>& schema = inputs[0].schema;
+        std::size_t eventCol = 0;
+        while (schema[eventCol].name != eventName) ++eventCol;
+        ColumnType eventType = nEvents > std::numeric_limits<std::int32_t>::max() ? ColumnType::Int64
+                                                                                  : ColumnType::Int32;
+        std::string title = inputs[0].title.empty() ? "merged" : inputs[0].title;
+        Output out(outPath, schema, eventCol, eventType, title);
+
+        // ---- k-way merge, one source after the other ----
+        const double budget = budgetMB * 1024. * 1024.;
+        std::uint64_t nRows = 0;
+        std::size_t   maxWays = 0;
+        for (std::size_t s = 0; s < sources.size(); ++s) {
+            std::vector<std::unique_ptr<Cursor>> cursors;
+            for (const auto& seg : segments)
+                if (inputs[seg.input].source == s) cursors.emplace_back(new Cursor(inputs[seg.input], seg, eventCol));
+            if (cursors.empty()) continue;
+            maxWays = std::max(maxWays, cursors.size());
+
+            const std::size_t chunkRows = std::max<std::size_t>(64,
+                static_cast<std::size_t>(budget / (cursors.size() * rowBytes(schema))));
+
+            // Smallest event first; ties keep input order
+            using Head = std::pair<std::int64_t, std::size_t>;
+            std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heap;
+            for (std::size_t k = 0; k < cursors.size(); ++k)
+                if (cursors[k]->load(chunkRows)) heap.push({cursors[k]->event(), k});
+
+            while (!heap.empty()) {
+                std::size_t k = heap.top().second;
+                heap.pop();
+                Cursor& cursor = *cursors[k];
+                out.write(cursor.input(), cursor.chunk(), sources[s].offset + cursor.event(), static_cast<std::int32_t>(s));
+                ++nRows;
+                if (cursor.next(chunkRows)) heap.push({cursor.event(), k});
+            }
+        }
+        out.close();
+
+        // ---- Source table ----
+        std::string base = outPath.substr(0, outPath.find_last_of('.'));
+        std::ofstream table(base + "_sources.csv");
+        table << "source,run,eventOffset,events,files\n";
+        for (std::size_t s = 0; s < sources.size(); ++s) {
+            table << s << "," << sources[s].run << "," << sources[s].offset << "," << sources[s].maxEvent + 1 << ",";
+            for (std::size_t f = 0; f < sources[s].files.size(); ++f) table << (f ? ";" : "") << sources[s].files[f];
+            table << "\n";
+        }
+
+        std::cout << outPath << ": " << nRows << " rows, " << nEvents << " event IDs from " << inputs.size()
+                  << " files in " << sources.size() << " sources (" << segments.size()
+                  << " sorted segments, up to " << maxWays << "-way); sources in " << base << "_sources.csv" << std::endl;
+    }
+    catch (const std::exception &e) {
+        std::cerr << "phoenix_merge: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}